@@ -1,4 +1,15 @@
 #include <bits/stdc++.h>
+#include <omp.h>
+#ifdef LAB2_WITH_MPI
+#include <mpi.h>
+#endif
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -15,6 +26,24 @@ struct CoordinateEntry {
     double value;
 };
 
+/**
+ * @brief Compressed Sparse Row (CSR) format for efficient sparse matrix storage
+ */
+struct CompressedSparseRowMatrix {
+    int numberOfRows;
+    int numberOfColumns;
+    vector<int> rowPointers;    // Size: numberOfRows + 1
+    vector<int> columnIndices;  // Size: numberOfNonZeros
+    vector<double> values;      // Size: numberOfNonZeros
+
+    CompressedSparseRowMatrix()
+        : numberOfRows(0), numberOfColumns(0) {}
+
+    int getNumberOfNonZeros() const {
+        return static_cast<int>(values.size());
+    }
+};
+
 // ============================================================================
 // Matrix Market File Reader
 // ============================================================================
@@ -174,80 +203,515 @@ private:
 extern "C" bool solve_dense_gpu(int n, const double* h_A_colmaj, const double* h_b, double* h_x, int nrhs, float* elapsed_ms_out);
 
 // ============================================================================
-// Utilities: convert COO to dense column-major, CPU solver, residuals, random b
+// Dense Storage: uninitialised buffers, parallel densification, binary files
 // ============================================================================
 
-static void coo_to_dense_colmaj(int nrows, int ncols, const vector<CoordinateEntry>& coo, vector<double>& A) {
-    A.assign(size_t(nrows) * size_t(ncols), 0.0);
-    int lda = nrows;
-    for (const auto &e : coo) {
-        if (e.row < 0 || e.column < 0 || e.row >= nrows || e.column >= ncols) continue;
-        A[size_t(e.column) * size_t(lda) + size_t(e.row)] += e.value;
+// Backing pages for large buffers: 2MB pages cut TLB misses of column walks over big matrices
+enum class PageMode { Default, TransparentHuge, ExplicitHuge };
+
+static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+static const char* page_mode_name(PageMode mode) {
+    switch (mode) {
+        case PageMode::TransparentHuge: return "thp";
+        case PageMode::ExplicitHuge: return "2MB";
+        default: return "4K";
     }
 }
 
-// Simple CPU Gaussian elimination with partial pivoting (overwrites A and b)
-static bool solve_dense_cpu_gauss(int n, vector<double>& A_colmaj, vector<double>& b, vector<double>& x) {
-    if (n <= 0) return false;
-    int lda = n;
-    // Convert column-major to row-major temporary for easier pivoting, or operate in column-major
-    // We'll work on column-major directly but index carefully: A[j*lda + i] is A(i,j)
-
-    // Make copies (we'll overwrite)
-    vector<double> aug(A_colmaj);
-    vector<double> rhs(b);
-
-    // Gaussian elimination with partial pivoting
-    for (int k = 0; k < n; ++k) {
-        // Find pivot row (max abs in column k from row k..n-1)
-        double maxval = 0.0;
-        int piv = -1;
-        for (int i = k; i < n; ++i) {
-            double v = fabs(aug[size_t(k) * size_t(lda) + size_t(i)]); // A(i,k)
-            if (v > maxval) { maxval = v; piv = i; }
+// Set when MAP_HUGETLB was refused (no reserved pages) and THP was used instead
+static atomic<bool> explicitHugePagesFellBack{false};
+
+// Page-aligned anonymous mapping, never touched here; bytes is a multiple of kHugePageSize
+static void* map_large_pages(size_t bytes, PageMode mode) {
+    if (mode == PageMode::ExplicitHuge) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return p;
+        explicitHugePagesFellBack = true;
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw bad_alloc();
+    madvise(p, bytes, MADV_HUGEPAGE);
+    return p;
+}
+
+/**
+ * @brief Allocator that leaves doubles uninitialised so the first write can happen in parallel
+ *
+ * std::vector<double>::assign/resize would zero-fill serially on one thread; with this
+ * allocator resize() only reserves 64-byte aligned pages and the caller decides which
+ * thread touches them first.
+ */
+template <typename T>
+struct UninitializedAllocator {
+    using value_type = T;
+    static constexpr size_t alignment = 64;
+
+    // The page mode travels with the buffer, so moved-into vectors free with the right call
+    using propagate_on_container_move_assignment = true_type;
+    using propagate_on_container_swap = true_type;
+
+    PageMode pages = PageMode::Default;
+
+    UninitializedAllocator() = default;
+    explicit UninitializedAllocator(PageMode mode) : pages(mode) {}
+    template <typename U>
+    UninitializedAllocator(const UninitializedAllocator<U>& other) : pages(other.pages) {}
+
+    T* allocate(size_t count) {
+        size_t bytes = count * sizeof(T);
+        if (pages != PageMode::Default && bytes >= kHugePageSize) {
+            return static_cast<T*>(map_large_pages(huge_page_round(bytes), pages));
+        }
+        return static_cast<T*>(::operator new(bytes, align_val_t(alignment)));
+    }
+    void deallocate(T* p, size_t count) {
+        size_t bytes = count * sizeof(T);
+        if (pages != PageMode::Default && bytes >= kHugePageSize) {
+            munmap(p, huge_page_round(bytes));
+            return;
         }
-        if (piv == -1 || maxval < 1e-15) {
-            return false; // singular or zero pivot
+        ::operator delete(p, align_val_t(alignment));
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            ::new (static_cast<void*>(p)) U;  // default-init: no zeroing
+        } else {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
         }
-        if (piv != k) {
-            // swap rows k and piv in aug (column-major storage)
-            for (int j = 0; j < n; ++j) {
-                std::swap(aug[size_t(j) * size_t(lda) + size_t(k)], aug[size_t(j) * size_t(lda) + size_t(piv)]);
-            }
-            std::swap(rhs[k], rhs[piv]);
+    }
+
+    template <typename U>
+    bool operator==(const UninitializedAllocator<U>& other) const { return pages == other.pages; }
+
+private:
+    static size_t huge_page_round(size_t bytes) { return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize; }
+};
+
+using DenseBuffer = vector<double, UninitializedAllocator<double>>;
+
+/**
+ * @brief COO -> dense column-major with threaded first-touch zeroing and a column-bucketed scatter
+ *
+ * Entries are bucketed by column (per-thread histograms, so no atomics), then every
+ * thread zeroes and fills the same static range of columns: each page is first touched
+ * by the thread that writes it, and no two threads ever write the same column.
+ */
+static void coo_to_dense_colmaj(int nrows, int ncols, const vector<CoordinateEntry>& coo, DenseBuffer& A) {
+    A.resize(size_t(nrows) * size_t(ncols));
+    size_t lda = size_t(nrows);
+    size_t nnz = coo.size();
+    int maxThreads = omp_get_max_threads();
+
+    // Per-thread column histograms over static slices of the COO array
+    vector<vector<size_t>> offsets(maxThreads, vector<size_t>(size_t(ncols) + 1, 0));
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        int tid = omp_get_thread_num();
+        size_t begin = nnz * tid / maxThreads, end = nnz * (tid + 1) / maxThreads;
+        vector<size_t>& counts = offsets[tid];
+        for (size_t k = begin; k < end; ++k) {
+            const auto &e = coo[k];
+            if (e.row < 0 || e.column < 0 || e.row >= nrows || e.column >= ncols) continue;
+            ++counts[e.column];
+        }
+    }
+
+    // Exclusive scan in (column, thread) order gives every thread private write cursors
+    vector<size_t> columnStarts(size_t(ncols) + 1, 0);
+    size_t running = 0;
+    for (int j = 0; j < ncols; ++j) {
+        columnStarts[j] = running;
+        for (int t = 0; t < maxThreads; ++t) {
+            size_t count = offsets[t][j];
+            offsets[t][j] = running;
+            running += count;
+        }
+    }
+    columnStarts[ncols] = running;
+
+    vector<pair<int, double>> bucketed(running);
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        int tid = omp_get_thread_num();
+        size_t begin = nnz * tid / maxThreads, end = nnz * (tid + 1) / maxThreads;
+        vector<size_t>& cursor = offsets[tid];
+        for (size_t k = begin; k < end; ++k) {
+            const auto &e = coo[k];
+            if (e.row < 0 || e.column < 0 || e.row >= nrows || e.column >= ncols) continue;
+            bucketed[cursor[e.column]++] = {e.row, e.value};
+        }
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int j = 0; j < ncols; ++j) {
+        double* column = A.data() + size_t(j) * lda;
+        fill(column, column + lda, 0.0);
+        for (size_t k = columnStarts[j]; k < columnStarts[j + 1]; ++k) {
+            column[bucketed[k].first] += bucketed[k].second;
+        }
+    }
+}
+
+/**
+ * @brief Raw binary dense matrix: a 64-byte header followed by rows*cols doubles, column-major
+ *
+ * The header size keeps the payload cache-line aligned inside a page-aligned mapping.
+ */
+struct DenseBinaryHeader {
+    char magic[8];      // "LAB2DNS\0"
+    int64_t rows;
+    int64_t cols;
+    char reserved[40];
+};
+static_assert(sizeof(DenseBinaryHeader) == 64, "binary header must stay 64 bytes");
+
+static constexpr char kDenseBinaryMagic[8] = {'L', 'A', 'B', '2', 'D', 'N', 'S', '\0'};
+
+static bool is_dense_binary_file(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[8] = {};
+    return in.read(magic, sizeof(magic)) && memcmp(magic, kDenseBinaryMagic, sizeof(magic)) == 0;
+}
+
+static bool write_dense_binary(const string& path, int nrows, int ncols, const double* A) {
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+    DenseBinaryHeader header = {};
+    memcpy(header.magic, kDenseBinaryMagic, sizeof(header.magic));
+    header.rows = nrows;
+    header.cols = ncols;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(A), streamsize(size_t(nrows) * size_t(ncols) * sizeof(double)));
+    return bool(out);
+}
+
+/**
+ * @brief Read-only memory mapping of a binary dense matrix; data() points straight into the file
+ */
+class MappedDenseMatrix {
+public:
+    MappedDenseMatrix() = default;
+    MappedDenseMatrix(const MappedDenseMatrix&) = delete;
+    MappedDenseMatrix& operator=(const MappedDenseMatrix&) = delete;
+    ~MappedDenseMatrix() {
+        if (mapping != nullptr) munmap(mapping, mappingSize);
+    }
+
+    bool open(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(DenseBinaryHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        mapping = p;
+        mappingSize = size_t(info.st_size);
+
+        const auto* header = static_cast<const DenseBinaryHeader*>(mapping);
+        if (memcmp(header->magic, kDenseBinaryMagic, sizeof(header->magic)) != 0 ||
+            header->rows <= 0 || header->cols <= 0 ||
+            mappingSize < sizeof(DenseBinaryHeader) + size_t(header->rows) * size_t(header->cols) * sizeof(double)) {
+            return false;
         }
+        rows = int(header->rows);
+        cols = int(header->cols);
+        madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    int getRows() const { return rows; }
+    int getColumns() const { return cols; }
+    const double* data() const {
+        return reinterpret_cast<const double*>(static_cast<const char*>(mapping) + sizeof(DenseBinaryHeader));
+    }
+
+private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    int rows = 0;
+    int cols = 0;
+};
+
+// ============================================================================
+// Dense CPU LU: blocked right-looking factorisation with lazy pivoting
+// ============================================================================
+
+/**
+ * @brief Where the factor's pages land and which thread updates them
+ *
+ * OwnerTiles deals 16-column tiles cyclically to the OpenMP threads and uses that one
+ * map for the first-touch copy and for every trailing update, so with bound threads
+ * (OMP_PROC_BIND=true) each thread streams pages on its own NUMA node for the whole
+ * factorisation. Serial reproduces the old single-threaded fill for comparison.
+ */
+enum class FirstTouch { Serial, StaticColumns, OwnerTiles };
+
+struct DensePlacement {
+    FirstTouch touch = FirstTouch::OwnerTiles;
+    PageMode pages = PageMode::Default;
+};
+
+static constexpr int kTileColumns = 16;
+
+// Call inside a parallel region: body(c0, c1) for this thread's tiles intersecting [firstColumn, n)
+template <typename Body>
+static void for_each_owned_tile(int firstColumn, int n, Body&& body) {
+    int tid = omp_get_thread_num(), threads = omp_get_num_threads();
+    int tiles = (n + kTileColumns - 1) / kTileColumns;
+    int firstTile = firstColumn / kTileColumns;
+    int tile = firstTile + ((tid - firstTile % threads) + threads) % threads;
+    for (; tile < tiles; tile += threads) {
+        body(max(firstColumn, tile * kTileColumns), min(n, (tile + 1) * kTileColumns));
+    }
+}
+
+/**
+ * @brief Dense LU factors (column-major) with pivots recorded, not applied retroactively
+ *
+ * Row swaps found while factorising panel k are applied to that panel and to the
+ * trailing columns only; the L columns of earlier panels are left in the row order
+ * they had when they were computed. The solve replays the swaps panel by panel, so
+ * no swap ever walks the full width of the matrix.
+ */
+template <typename T>
+struct DenseLUFactorization {
+    int n = 0;
+    int blockSize = 64;
+    DensePlacement placement;
+    vector<T, UninitializedAllocator<T>> lu;  // L strictly below the diagonal (unit), U on and above
+    vector<int> ipiv;   // row exchanged with row k while factorising column k
+};
 
-        // Eliminate rows below k
-        double Akk = aug[size_t(k) * size_t(lda) + size_t(k)];
-        if (fabs(Akk) < 1e-15) return false;
-        for (int i = k + 1; i < n; ++i) {
-            double Aik = aug[size_t(k) * size_t(lda) + size_t(i)];
-            double mult = Aik / Akk;
-            // row i = row i - mult * row k
-            for (int j = k; j < n; ++j) {
-                double Akj = aug[size_t(j) * size_t(lda) + size_t(k)]; // A(k,j) ??? need careful indexing
-                // Wait: indexing is column-major: element (row=i, col=j) is aug[j*lda + i]
-                // We want A(i,j) -= mult * A(k,j)
-                aug[size_t(j) * size_t(lda) + size_t(i)] -= mult * aug[size_t(j) * size_t(lda) + size_t(k)];
+// Unblocked partial-pivoting LU of the panel A[j0:n, j0:j1]; swaps touch panel columns only
+template <typename T>
+static bool lu_factorize_panel(int n, T* A, int lda, int j0, int j1, int* ipiv) {
+    for (int c = j0; c < j1; ++c) {
+        T* colC = A + size_t(c) * size_t(lda);
+        int piv = c;
+        T maxval = fabs(colC[c]);
+        for (int i = c + 1; i < n; ++i) {
+            T v = fabs(colC[i]);
+            if (v > maxval) { maxval = v; piv = i; }
+        }
+        if (maxval < 1e-15) return false; // singular or zero pivot
+        ipiv[c] = piv;
+        if (piv != c) {
+            for (int t = j0; t < j1; ++t) {
+                T* colT = A + size_t(t) * size_t(lda);
+                std::swap(colT[c], colT[piv]);
             }
-            rhs[i] -= mult * rhs[k];
+        }
+        T inversePivot = T(1) / colC[c];
+        for (int i = c + 1; i < n; ++i) colC[i] *= inversePivot;
+        for (int t = c + 1; t < j1; ++t) {
+            T* colT = A + size_t(t) * size_t(lda);
+            T ukt = colT[c];
+            if (ukt == T(0)) continue;
+            for (int i = c + 1; i < n; ++i) colT[i] -= colC[i] * ukt;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Update trailing columns [t0, t1) with the factorised panel [j0, j1)
+ *
+ * Per column: laswp (panel swaps only), unit-lower trsm for U12, then the
+ * A22 -= L21 * U12 update. Columns are independent, so callers split them across threads.
+ */
+template <typename T>
+static void lu_update_trailing(int n, T* A, int lda, int j0, int j1, const int* ipiv, int t0, int t1) {
+    for (int t = t0; t < t1; ++t) {
+        T* colT = A + size_t(t) * size_t(lda);
+        for (int c = j0; c < j1; ++c) {
+            if (ipiv[c] != c) std::swap(colT[c], colT[ipiv[c]]);
+        }
+        for (int c = j0; c < j1; ++c) {
+            const T* colC = A + size_t(c) * size_t(lda);
+            T ukt = colT[c];
+            if (ukt == T(0)) continue;
+            for (int i = c + 1; i < n; ++i) colT[i] -= colC[i] * ukt;
         }
     }
+}
 
-    // Back substitution
-    x.assign(n, 0.0);
-    for (int i = n - 1; i >= 0; --i) {
-        double sum = rhs[i];
-        for (int j = i + 1; j < n; ++j) {
-            sum -= aug[size_t(j) * size_t(lda) + size_t(i)] * x[j];
+// ownerTiles: trailing columns go to their fixed tile owner instead of a fresh static split per panel
+template <typename T>
+static bool lu_factorize_blocked(int n, T* A, int lda, int* ipiv, int blockSize, bool ownerTiles = true) {
+    for (int j0 = 0; j0 < n; j0 += blockSize) {
+        int j1 = min(n, j0 + blockSize);
+        if (!lu_factorize_panel(n, A, lda, j0, j1, ipiv)) return false;
+
+        int trailingTasks = (n - j1 + kTileColumns - 1) / kTileColumns;
+        if (ownerTiles) {
+            #pragma omp parallel if (trailingTasks > 1)
+            for_each_owned_tile(j1, n, [&](int t0, int t1) { lu_update_trailing(n, A, lda, j0, j1, ipiv, t0, t1); });
+            continue;
+        }
+        #pragma omp parallel for schedule(static) if (trailingTasks > 1)
+        for (int task = 0; task < trailingTasks; ++task) {
+            int t0 = j1 + task * kTileColumns;
+            lu_update_trailing(n, A, lda, j0, j1, ipiv, t0, min(n, t0 + kTileColumns));
+        }
+    }
+    return true;
+}
+
+// Size F.lu for n and copy A into it; the copy is the first touch and follows F.placement
+template <typename T>
+static void place_dense_factor(int n, const double* A_colmaj, DenseLUFactorization<T>& F) {
+    F.n = n;
+    if (F.lu.get_allocator().pages != F.placement.pages) {
+        F.lu = vector<T, UninitializedAllocator<T>>(UninitializedAllocator<T>(F.placement.pages));
+    }
+    F.lu.resize(size_t(n) * size_t(n));
+    F.ipiv.assign(n, 0);
+    // The copy is the first touch of F.lu: it decides which NUMA node holds each column
+    auto copyColumns = [&](int c0, int c1) {
+        for (int j = c0; j < c1; ++j) {
+            for (int i = 0; i < n; ++i) F.lu[size_t(j) * size_t(n) + i] = T(A_colmaj[size_t(j) * size_t(n) + i]);
+        }
+    };
+    switch (F.placement.touch) {
+        case FirstTouch::Serial:
+            copyColumns(0, n);
+            break;
+        case FirstTouch::StaticColumns:
+            #pragma omp parallel for schedule(static)
+            for (int j = 0; j < n; ++j) copyColumns(j, j + 1);
+            break;
+        case FirstTouch::OwnerTiles:
+            #pragma omp parallel
+            for_each_owned_tile(0, n, copyColumns);
+            break;
+    }
+}
+
+template <typename T>
+static bool factorize_dense_lu(int n, const double* A_colmaj, DenseLUFactorization<T>& F, int blockSize = 64) {
+    F.blockSize = blockSize;
+    place_dense_factor(n, A_colmaj, F);
+    return lu_factorize_blocked(n, F.lu.data(), n, F.ipiv.data(), blockSize,
+                                F.placement.touch == FirstTouch::OwnerTiles);
+}
+
+// Solve A x = b with the factors; x holds b on entry
+template <typename T>
+static void solve_dense_lu(const DenseLUFactorization<T>& F, double* x) {
+    int n = F.n;
+    size_t lda = size_t(n);
+    for (int j0 = 0; j0 < n; j0 += F.blockSize) {
+        int j1 = min(n, j0 + F.blockSize);
+        for (int c = j0; c < j1; ++c) {
+            if (F.ipiv[c] != c) std::swap(x[c], x[F.ipiv[c]]);
+        }
+        for (int c = j0; c < j1; ++c) {
+            const T* colC = F.lu.data() + size_t(c) * lda;
+            double xc = x[c];
+            for (int i = c + 1; i < n; ++i) x[i] -= double(colC[i]) * xc;
+        }
+    }
+    for (int j = n - 1; j >= 0; --j) {
+        const T* colJ = F.lu.data() + size_t(j) * lda;
+        x[j] /= double(colJ[j]);
+        double xj = x[j];
+        for (int i = 0; i < j; ++i) x[i] -= double(colJ[i]) * xj;
+    }
+}
+
+template <typename T>
+static void solve_dense_lu(const DenseLUFactorization<T>& F, vector<double>& x) {
+    solve_dense_lu(F, x.data());
+}
+
+/**
+ * @brief Partial-pivoting solve for a compile-time n, fully unrolled
+ *
+ * The augmented [A | b] lives in a local array indexed only by constants once the loops
+ * are unrolled, so the compiler keeps it in registers. Pivoting is branch-free: every
+ * row below k is compare-exchanged into row k, leaving the largest |a(i,k)| on top.
+ */
+template <int N>
+static bool solve_fixed_size(const double* A_colmaj, const double* b, double* x) {
+    double a[N][N + 1];
+    #pragma GCC unroll 16
+    for (int i = 0; i < N; ++i) {
+        #pragma GCC unroll 16
+        for (int j = 0; j < N; ++j) a[i][j] = A_colmaj[j * N + i];
+        a[i][N] = b[i];
+    }
+    bool ok = true;
+    #pragma GCC unroll 16
+    for (int k = 0; k < N; ++k) {
+        #pragma GCC unroll 16
+        for (int i = k + 1; i < N; ++i) {
+            bool larger = fabs(a[i][k]) > fabs(a[k][k]);
+            #pragma GCC unroll 17
+            for (int j = k; j <= N; ++j) {
+                double top = a[k][j], other = a[i][j];
+                a[k][j] = larger ? other : top;
+                a[i][j] = larger ? top : other;
+            }
         }
-        double Aii = aug[size_t(i) * size_t(lda) + size_t(i)];
-        if (fabs(Aii) < 1e-15) return false;
-        x[i] = sum / Aii;
+        ok &= fabs(a[k][k]) >= 1e-15;
+        double inversePivot = 1.0 / a[k][k];
+        #pragma GCC unroll 16
+        for (int i = k + 1; i < N; ++i) {
+            double l = a[i][k] * inversePivot;
+            #pragma GCC unroll 17
+            for (int j = k + 1; j <= N; ++j) a[i][j] -= l * a[k][j];
+        }
+    }
+    double solution[N];
+    #pragma GCC unroll 16
+    for (int i = N - 1; i >= 0; --i) {
+        double s = a[i][N];
+        #pragma GCC unroll 16
+        for (int j = i + 1; j < N; ++j) s -= a[i][j] * solution[j];
+        solution[i] = s / a[i][i];
+    }
+    #pragma GCC unroll 16
+    for (int i = 0; i < N; ++i) x[i] = solution[i];
+    return ok;
+}
+
+using FixedSizeSolver = bool (*)(const double*, const double*, double*);
+static constexpr int kMaxFixedSize = 16;
+
+template <size_t... Sizes>
+static constexpr array<FixedSizeSolver, sizeof...(Sizes)> make_fixed_size_solvers(index_sequence<Sizes...>) {
+    return {{&solve_fixed_size<int(Sizes) + 1>...}};
+}
+
+// kFixedSizeSolvers[n - 1] solves an n x n system
+static constexpr auto kFixedSizeSolvers = make_fixed_size_solvers(make_index_sequence<kMaxFixedSize>{});
+
+// CPU LU solve of A x = b (A and b are left untouched); n <= 16 takes the unrolled kernels
+static bool solve_dense_cpu_gauss(int n, const double* A_colmaj, const vector<double>& b, vector<double>& x,
+                                  const DensePlacement& placement = {}) {
+    if (n <= 0) return false;
+    if (n <= kMaxFixedSize) {
+        x.resize(n);
+        return kFixedSizeSolvers[n - 1](A_colmaj, b.data(), x.data());
     }
+    DenseLUFactorization<double> F;
+    F.placement = placement;
+    if (!factorize_dense_lu(n, A_colmaj, F)) return false;
+    x = b;
+    solve_dense_lu(F, x);
     return true;
 }
 
+// ============================================================================
+// Utilities: random right-hand side
+// ============================================================================
+
 static vector<double> generate_random_b(int n, unsigned int seed=12345) {
     vector<double> b(n);
     std::mt19937 rng(seed);
@@ -256,78 +720,3733 @@ static vector<double> generate_random_b(int n, unsigned int seed=12345) {
     return b;
 }
 
-static double compute_residual_norm(int n, const vector<double>& A_colmaj, const vector<double>& x, const vector<double>& b) {
-    int lda = n;
-    vector<double> r(n, 0.0);
-    for (int i = 0; i < n; ++i) {
-        double s = 0.0;
-        for (int j = 0; j < n; ++j) {
-            s += A_colmaj[size_t(j) * size_t(lda) + size_t(i)] * x[j];
+// ============================================================================
+// Sparse Path: COO -> CSR, threaded SpMV and vector kernels
+// ============================================================================
+
+/**
+ * @brief Convert COO entries to CSR, summing duplicates (the COO input is left untouched)
+ */
+static CompressedSparseRowMatrix coo_to_csr(int nrows, int ncols, const vector<CoordinateEntry>& coo) {
+    CompressedSparseRowMatrix csr;
+    csr.numberOfRows = nrows;
+    csr.numberOfColumns = ncols;
+
+    // Bucket entries by row (counting sort keeps this O(nnz))
+    vector<int> rowStarts(size_t(nrows) + 1, 0);
+    for (const auto &e : coo) {
+        if (e.row < 0 || e.column < 0 || e.row >= nrows || e.column >= ncols) continue;
+        ++rowStarts[e.row + 1];
+    }
+    for (int i = 0; i < nrows; ++i) rowStarts[i + 1] += rowStarts[i];
+
+    vector<pair<int, double>> bucketed(rowStarts[nrows]);
+    vector<int> cursor(rowStarts.begin(), rowStarts.end() - 1);
+    for (const auto &e : coo) {
+        if (e.row < 0 || e.column < 0 || e.row >= nrows || e.column >= ncols) continue;
+        bucketed[cursor[e.row]++] = {e.column, e.value};
+    }
+
+    // Sort every row by column and merge duplicates in place
+    vector<int> rowLengths(nrows, 0);
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < nrows; ++i) {
+        auto first = bucketed.begin() + rowStarts[i];
+        auto last = bucketed.begin() + rowStarts[i + 1];
+        sort(first, last, [](const pair<int, double>& a, const pair<int, double>& b) {
+            return a.first < b.first;
+        });
+        auto out = first;
+        for (auto it = first; it != last; ++it) {
+            if (out != first && prev(out)->first == it->first) {
+                prev(out)->second += it->second;
+            } else {
+                *out++ = *it;
+            }
         }
-        r[i] = s - b[i];
+        rowLengths[i] = int(out - first);
     }
-    double norm = 0.0;
-    for (int i = 0; i < n; ++i) norm += r[i] * r[i];
-    return sqrt(norm);
+
+    csr.rowPointers.assign(size_t(nrows) + 1, 0);
+    for (int i = 0; i < nrows; ++i) csr.rowPointers[i + 1] = csr.rowPointers[i] + rowLengths[i];
+    csr.columnIndices.resize(csr.rowPointers[nrows]);
+    csr.values.resize(csr.rowPointers[nrows]);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < nrows; ++i) {
+        for (int k = 0; k < rowLengths[i]; ++k) {
+            csr.columnIndices[csr.rowPointers[i] + k] = bucketed[rowStarts[i] + k].first;
+            csr.values[csr.rowPointers[i] + k] = bucketed[rowStarts[i] + k].second;
+        }
+    }
+    return csr;
 }
 
-int main(int argc, char** argv) {
-    if (argc < 2) {
-        cout << "Usage: " << argv[0] << " <matrix.mtx> [--repeat N]" << endl;
-        return 1;
+// y = A * x, rows split statically across threads
+static void csr_spmv(const CompressedSparseRowMatrix& A, const double* x, double* y) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < A.numberOfRows; ++i) {
+        double s = 0.0;
+        for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+            s += A.values[k] * x[A.columnIndices[k]];
+        }
+        y[i] = s;
     }
-    string matrixPath = argv[1];
-    int repeat = 5;
-    for (int i = 2; i < argc; ++i) {
-        string s = argv[i];
-        if (s == "--repeat" && i + 1 < argc) { repeat = atoi(argv[++i]); }
+}
+
+static double parallel_dot(const vector<double>& a, const vector<double>& b) {
+    double s = 0.0;
+    int n = int(a.size());
+    #pragma omp parallel for schedule(static) reduction(+:s)
+    for (int i = 0; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+static double parallel_norm2(const vector<double>& a) {
+    return sqrt(parallel_dot(a, a));
+}
+
+/**
+ * @brief Residual of a computed solution
+ *
+ * norm is ||b - A x||_2; relative is the normwise backward error
+ * ||r||_inf / (||A||_inf ||x||_inf + ||b||_inf), which is O(machine eps) for a stable solve.
+ */
+struct ResidualReport {
+    double norm = 0.0;
+    double relative = 0.0;
+};
+
+// Kahan-compensated accumulator: keeps sum-of-squares accurate at n = 10^5 and beyond
+struct CompensatedSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double value) {
+        double y = value - compensation;
+        double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
     }
+};
 
-    int nrows = 0, ncols = 0;
-    vector<CoordinateEntry> coo;
-    if (!MatrixMarketReader::readMatrixMarketFile(matrixPath, nrows, ncols, coo)) {
-        cerr << "Failed to read matrix: " << matrixPath << endl;
-        return 1;
+/**
+ * @brief Residual straight from the CSR in one O(nnz) threaded pass (r is never stored)
+ *
+ * Each thread owns a static row range and keeps a compensated partial sum of r_i^2;
+ * the partials are combined in thread order, so the result does not depend on timing.
+ */
+static ResidualReport compute_residual(const CompressedSparseRowMatrix& A, const vector<double>& x, const vector<double>& b) {
+    int nrows = A.numberOfRows;
+    int maxThreads = omp_get_max_threads();
+    vector<CompensatedSum> partialSquares(maxThreads);
+    vector<double> partialResidualMax(maxThreads, 0.0), partialRowSumMax(maxThreads, 0.0);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        int rowBegin = int((long long)nrows * tid / threads);
+        int rowEnd = int((long long)nrows * (tid + 1) / threads);
+        CompensatedSum squares;
+        double residualMax = 0.0, rowSumMax = 0.0;
+        for (int i = rowBegin; i < rowEnd; ++i) {
+            double s = 0.0, rowSum = 0.0;
+            for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+                s += A.values[k] * x[A.columnIndices[k]];
+                rowSum += fabs(A.values[k]);
+            }
+            double ri = s - b[i];
+            squares.add(ri * ri);
+            residualMax = max(residualMax, fabs(ri));
+            rowSumMax = max(rowSumMax, rowSum);
+        }
+        partialSquares[tid] = squares;
+        partialResidualMax[tid] = residualMax;
+        partialRowSumMax[tid] = rowSumMax;
     }
-    if (nrows != ncols) {
-        cerr << "Matrix must be square for this solver" << endl;
-        return 1;
+
+    CompensatedSum total;
+    double residualMax = 0.0, normA = 0.0, normX = 0.0, normB = 0.0;
+    for (int t = 0; t < maxThreads; ++t) {
+        total.add(partialSquares[t].sum);
+        total.add(-partialSquares[t].compensation);
+        residualMax = max(residualMax, partialResidualMax[t]);
+        normA = max(normA, partialRowSumMax[t]);
     }
-    int n = nrows;
-    vector<double> A;
-    coo_to_dense_colmaj(n, n, coo, A);
+    int ncols = int(x.size());
+    #pragma omp parallel for schedule(static) reduction(max:normX)
+    for (int j = 0; j < ncols; ++j) normX = max(normX, fabs(x[j]));
+    #pragma omp parallel for schedule(static) reduction(max:normB)
+    for (int i = 0; i < nrows; ++i) normB = max(normB, fabs(b[i]));
 
-    // Generate random b
-    vector<double> b = generate_random_b(n, 1337);
+    ResidualReport report;
+    report.norm = sqrt(max(0.0, total.sum));
+    double scale = normA * normX + normB;
+    report.relative = scale > 0.0 ? residualMax / scale : 0.0;
+    return report;
+}
 
-    // CPU solve
-    vector<double> x_cpu;
-    vector<double> A_copy = A; // gauss overwrites
-    vector<double> b_copy = b;
+/**
+ * @brief Dense residual for inputs that only exist in dense form (binary files)
+ *
+ * Each thread owns a row range and sweeps the columns in order, so every access to
+ * A is contiguous; sums and norms follow compute_residual.
+ */
+static ResidualReport compute_residual_dense(int n, const double* A, const vector<double>& x, const vector<double>& b) {
+    int maxThreads = omp_get_max_threads();
+    vector<CompensatedSum> partialSquares(maxThreads);
+    vector<double> partialResidualMax(maxThreads, 0.0), partialRowSumMax(maxThreads, 0.0);
 
-    cout << "Running CPU solver (Gaussian elimination fallback) ..." << endl;
-    auto t0 = chrono::high_resolution_clock::now();
-    bool ok_cpu = solve_dense_cpu_gauss(n, A_copy, b_copy, x_cpu);
-    auto t1 = chrono::high_resolution_clock::now();
-    double cpu_ms = chrono::duration<double, milli>(t1 - t0).count();
-    if (!ok_cpu) {
-        cerr << "CPU solver failed (singular?)" << endl;
-    } else {
-        double res = compute_residual_norm(n, A, x_cpu, b);
-        cout << "CPU time (ms): " << cpu_ms << ", residual norm: " << res << endl;
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        int tid = omp_get_thread_num();
+        int rowBegin = int((long long)n * tid / maxThreads);
+        int rowEnd = int((long long)n * (tid + 1) / maxThreads);
+        vector<double> r(rowEnd - rowBegin, 0.0), rowSums(rowEnd - rowBegin, 0.0);
+        for (int j = 0; j < n; ++j) {
+            const double* column = A + size_t(j) * size_t(n);
+            double xj = x[j];
+            for (int i = rowBegin; i < rowEnd; ++i) {
+                r[i - rowBegin] += column[i] * xj;
+                rowSums[i - rowBegin] += fabs(column[i]);
+            }
+        }
+        CompensatedSum squares;
+        for (int i = rowBegin; i < rowEnd; ++i) {
+            double ri = r[i - rowBegin] - b[i];
+            squares.add(ri * ri);
+            partialResidualMax[tid] = max(partialResidualMax[tid], fabs(ri));
+            partialRowSumMax[tid] = max(partialRowSumMax[tid], rowSums[i - rowBegin]);
+        }
+        partialSquares[tid] = squares;
     }
 
-    // GPU solve
-    vector<double> x_gpu(n, 0.0);
-    float gpu_ms = 0.0f;
-    cout << "Running GPU solver (cuSOLVER) ..." << endl;
-    bool ok_gpu = solve_dense_gpu(n, A.data(), b.data(), x_gpu.data(), 1, &gpu_ms);
-    if (!ok_gpu) {
-        cerr << "GPU solver returned failure" << endl;
-    } else {
-        double resg = compute_residual_norm(n, A, x_gpu, b);
-        cout << "GPU time (ms): " << gpu_ms << ", residual norm: " << resg << endl;
+    CompensatedSum total;
+    double residualMax = 0.0, normA = 0.0, normX = 0.0, normB = 0.0;
+    for (int t = 0; t < maxThreads; ++t) {
+        total.add(partialSquares[t].sum);
+        total.add(-partialSquares[t].compensation);
+        residualMax = max(residualMax, partialResidualMax[t]);
+        normA = max(normA, partialRowSumMax[t]);
+    }
+    for (int i = 0; i < n; ++i) {
+        normX = max(normX, fabs(x[i]));
+        normB = max(normB, fabs(b[i]));
     }
 
-    return 0;
-}
\ No newline at end of file
+    ResidualReport report;
+    report.norm = sqrt(max(0.0, total.sum));
+    double scale = normA * normX + normB;
+    report.relative = scale > 0.0 ? residualMax / scale : 0.0;
+    return report;
+}
+
+static void print_solve_report(const string& label, double ms, const ResidualReport& residual) {
+    cout << label << " time (ms): " << ms << ", residual norm: " << residual.norm
+         << ", relative residual: " << residual.relative << endl;
+}
+
+// ============================================================================
+// Incomplete LU Preconditioners (ILU(0) and ILUT)
+// ============================================================================
+
+/**
+ * @brief Incomplete factorisation M = L*U applied as z = M^{-1} r
+ *
+ * L is unit lower triangular (strict part stored), U is upper triangular with
+ * its diagonal kept separately as reciprocals.
+ */
+class IncompleteLUPreconditioner {
+public:
+    /**
+     * @brief ILU(0): factorise on the sparsity pattern of A (plus the diagonal)
+     */
+    static IncompleteLUPreconditioner buildILU0(const CompressedSparseRowMatrix& A) {
+        int n = A.numberOfRows;
+        CompressedSparseRowMatrix lu = withExplicitDiagonal(A);
+
+        vector<int> diagonalPositions(n, -1);
+        for (int i = 0; i < n; ++i) {
+            for (int k = lu.rowPointers[i]; k < lu.rowPointers[i + 1]; ++k) {
+                if (lu.columnIndices[k] == i) { diagonalPositions[i] = k; break; }
+            }
+        }
+
+        // IKJ variant: eliminate row i using the already factorised rows k < i
+        vector<int> positionInRow(n, -1);
+        for (int i = 0; i < n; ++i) {
+            int rowStart = lu.rowPointers[i];
+            int rowEnd = lu.rowPointers[i + 1];
+            for (int k = rowStart; k < rowEnd; ++k) positionInRow[lu.columnIndices[k]] = k;
+
+            for (int k = rowStart; k < rowEnd && lu.columnIndices[k] < i; ++k) {
+                int pivotRow = lu.columnIndices[k];
+                double multiplier = lu.values[k] / lu.values[diagonalPositions[pivotRow]];
+                lu.values[k] = multiplier;
+                for (int m = diagonalPositions[pivotRow] + 1; m < lu.rowPointers[pivotRow + 1]; ++m) {
+                    int target = positionInRow[lu.columnIndices[m]];
+                    if (target >= 0) lu.values[target] -= multiplier * lu.values[m];
+                }
+            }
+            guardPivot(lu.values[diagonalPositions[i]], rowNorm(A, i));
+
+            for (int k = rowStart; k < rowEnd; ++k) positionInRow[lu.columnIndices[k]] = -1;
+        }
+
+        IncompleteLUPreconditioner preconditioner;
+        preconditioner.splitFactors(lu, diagonalPositions);
+        return preconditioner;
+    }
+
+    /**
+     * @brief ILUT(p, tau): threshold dropping with at most p fill entries per row in L and in U
+     */
+    static IncompleteLUPreconditioner buildILUT(const CompressedSparseRowMatrix& A, int fillPerRow, double dropTolerance) {
+        int n = A.numberOfRows;
+        IncompleteLUPreconditioner preconditioner;
+        CompressedSparseRowMatrix& L = preconditioner.lowerFactor;
+        CompressedSparseRowMatrix& U = preconditioner.upperFactor;
+        L.numberOfRows = L.numberOfColumns = n;
+        U.numberOfRows = U.numberOfColumns = n;
+        L.rowPointers.assign(size_t(n) + 1, 0);
+        U.rowPointers.assign(size_t(n) + 1, 0);
+        preconditioner.inverseDiagonal.assign(n, 0.0);
+
+        vector<double> work(n, 0.0);
+        vector<char> occupied(n, 0);
+        vector<int> upperPattern;
+        priority_queue<int, vector<int>, greater<int>> lowerPattern;
+        vector<pair<int, double>> kept;
+
+        for (int i = 0; i < n; ++i) {
+            double threshold = dropTolerance * rowNorm(A, i);
+            upperPattern.clear();
+
+            // Scatter row i of A into the dense work row
+            for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+                int j = A.columnIndices[k];
+                work[j] = A.values[k];
+                occupied[j] = 1;
+                if (j < i) lowerPattern.push(j); else upperPattern.push_back(j);
+            }
+            if (!occupied[i]) { occupied[i] = 1; work[i] = 0.0; upperPattern.push_back(i); }
+
+            // Eliminate with previous U rows in increasing column order (fill may add columns)
+            kept.clear();
+            while (!lowerPattern.empty()) {
+                int k = lowerPattern.top();
+                lowerPattern.pop();
+                double multiplier = work[k] * preconditioner.inverseDiagonal[k];
+                occupied[k] = 0;
+                work[k] = 0.0;
+                if (fabs(multiplier) < threshold) continue;
+                kept.push_back({k, multiplier});
+
+                for (int m = U.rowPointers[k]; m < U.rowPointers[k + 1]; ++m) {
+                    int j = U.columnIndices[m];
+                    if (!occupied[j]) {
+                        occupied[j] = 1;
+                        work[j] = 0.0;
+                        if (j < i) lowerPattern.push(j); else upperPattern.push_back(j);
+                    }
+                    work[j] -= multiplier * U.values[m];
+                }
+            }
+            keepLargest(kept, fillPerRow);
+            appendRow(L, i, kept);
+
+            // Diagonal is always kept; the strict upper part is thresholded and capped
+            double diagonal = work[i];
+            guardPivot(diagonal, rowNorm(A, i));
+            preconditioner.inverseDiagonal[i] = 1.0 / diagonal;
+            kept.clear();
+            for (int j : upperPattern) {
+                if (j != i && fabs(work[j]) >= threshold) kept.push_back({j, work[j]});
+                occupied[j] = 0;
+                work[j] = 0.0;
+            }
+            keepLargest(kept, fillPerRow);
+            appendRow(U, i, kept);
+        }
+        return preconditioner;
+    }
+
+    /**
+     * @brief Apply z = U^{-1} L^{-1} r
+     */
+    void apply(const vector<double>& r, vector<double>& z) const {
+        int n = lowerFactor.numberOfRows;
+        z.resize(n);
+        for (int i = 0; i < n; ++i) {
+            double s = r[i];
+            for (int k = lowerFactor.rowPointers[i]; k < lowerFactor.rowPointers[i + 1]; ++k) {
+                s -= lowerFactor.values[k] * z[lowerFactor.columnIndices[k]];
+            }
+            z[i] = s;
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            double s = z[i];
+            for (int k = upperFactor.rowPointers[i]; k < upperFactor.rowPointers[i + 1]; ++k) {
+                s -= upperFactor.values[k] * z[upperFactor.columnIndices[k]];
+            }
+            z[i] = s * inverseDiagonal[i];
+        }
+    }
+
+    int getNumberOfNonZeros() const {
+        return lowerFactor.getNumberOfNonZeros() + upperFactor.getNumberOfNonZeros()
+             + static_cast<int>(inverseDiagonal.size());
+    }
+
+private:
+    CompressedSparseRowMatrix lowerFactor;  // strict lower part, unit diagonal implied
+    CompressedSparseRowMatrix upperFactor;  // strict upper part
+    vector<double> inverseDiagonal;
+
+    static double rowNorm(const CompressedSparseRowMatrix& A, int i) {
+        double s = 0.0;
+        for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) s += A.values[k] * A.values[k];
+        return sqrt(s);
+    }
+
+    // Replace a vanishing pivot with a small multiple of the row norm instead of breaking down
+    static void guardPivot(double& pivot, double rowScale) {
+        double floorValue = 1e-8 * (rowScale > 0.0 ? rowScale : 1.0);
+        if (fabs(pivot) < floorValue) pivot = (pivot < 0.0 ? -floorValue : floorValue);
+    }
+
+    static CompressedSparseRowMatrix withExplicitDiagonal(const CompressedSparseRowMatrix& A) {
+        CompressedSparseRowMatrix result;
+        result.numberOfRows = A.numberOfRows;
+        result.numberOfColumns = A.numberOfColumns;
+        result.rowPointers.assign(size_t(A.numberOfRows) + 1, 0);
+        result.columnIndices.reserve(A.columnIndices.size() + A.numberOfRows);
+        result.values.reserve(A.values.size() + A.numberOfRows);
+        for (int i = 0; i < A.numberOfRows; ++i) {
+            bool diagonalSeen = false;
+            for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+                int j = A.columnIndices[k];
+                if (!diagonalSeen && j > i) {
+                    result.columnIndices.push_back(i);
+                    result.values.push_back(0.0);
+                    diagonalSeen = true;
+                }
+                if (j == i) diagonalSeen = true;
+                result.columnIndices.push_back(j);
+                result.values.push_back(A.values[k]);
+            }
+            if (!diagonalSeen) {
+                result.columnIndices.push_back(i);
+                result.values.push_back(0.0);
+            }
+            result.rowPointers[i + 1] = static_cast<int>(result.values.size());
+        }
+        return result;
+    }
+
+    static void keepLargest(vector<pair<int, double>>& entries, int count) {
+        if (count >= 0 && static_cast<int>(entries.size()) > count) {
+            nth_element(entries.begin(), entries.begin() + count, entries.end(),
+                        [](const pair<int, double>& a, const pair<int, double>& b) {
+                            return fabs(a.second) > fabs(b.second);
+                        });
+            entries.resize(count);
+        }
+        sort(entries.begin(), entries.end());
+    }
+
+    static void appendRow(CompressedSparseRowMatrix& M, int row, const vector<pair<int, double>>& entries) {
+        for (const auto& entry : entries) {
+            M.columnIndices.push_back(entry.first);
+            M.values.push_back(entry.second);
+        }
+        M.rowPointers[row + 1] = static_cast<int>(M.values.size());
+    }
+
+    void splitFactors(const CompressedSparseRowMatrix& lu, const vector<int>& diagonalPositions) {
+        int n = lu.numberOfRows;
+        lowerFactor.numberOfRows = lowerFactor.numberOfColumns = n;
+        upperFactor.numberOfRows = upperFactor.numberOfColumns = n;
+        lowerFactor.rowPointers.assign(size_t(n) + 1, 0);
+        upperFactor.rowPointers.assign(size_t(n) + 1, 0);
+        inverseDiagonal.assign(n, 0.0);
+        for (int i = 0; i < n; ++i) {
+            for (int k = lu.rowPointers[i]; k < lu.rowPointers[i + 1]; ++k) {
+                if (k < diagonalPositions[i]) {
+                    lowerFactor.columnIndices.push_back(lu.columnIndices[k]);
+                    lowerFactor.values.push_back(lu.values[k]);
+                } else if (k > diagonalPositions[i]) {
+                    upperFactor.columnIndices.push_back(lu.columnIndices[k]);
+                    upperFactor.values.push_back(lu.values[k]);
+                }
+            }
+            inverseDiagonal[i] = 1.0 / lu.values[diagonalPositions[i]];
+            lowerFactor.rowPointers[i + 1] = lowerFactor.getNumberOfNonZeros();
+            upperFactor.rowPointers[i + 1] = upperFactor.getNumberOfNonZeros();
+        }
+    }
+};
+
+// ============================================================================
+// Krylov Solvers: restarted GMRES(m) and BiCGStab, right-preconditioned
+// ============================================================================
+
+struct KrylovOptions {
+    int restart = 50;
+    int maxIterations = 1000;
+    double tolerance = 1e-10;   // on ||b - A x|| / ||b||
+};
+
+struct KrylovResult {
+    bool converged = false;
+    int iterations = 0;
+    double relativeResidual = 0.0;
+};
+
+static void apply_preconditioner(const IncompleteLUPreconditioner* M, const vector<double>& r, vector<double>& z) {
+    if (M) {
+        M->apply(r, z);
+    } else {
+        z = r;
+    }
+}
+
+static KrylovResult solve_gmres(const CompressedSparseRowMatrix& A, const IncompleteLUPreconditioner* M,
+                                const vector<double>& b, vector<double>& x, const KrylovOptions& opts) {
+    int n = A.numberOfRows;
+    int m = max(1, opts.restart);
+    KrylovResult result;
+    x.assign(n, 0.0);
+
+    double bnorm = parallel_norm2(b);
+    if (bnorm == 0.0) { result.converged = true; return result; }
+
+    vector<vector<double>> V(m + 1, vector<double>(n));
+    vector<double> H(size_t(m + 1) * size_t(m), 0.0);  // column-major (m+1) x m
+    vector<double> cs(m), sn(m), g(m + 1), y(m);
+    vector<double> r(n), w(n), z(n);
+
+    auto residual_into = [&]() {
+        csr_spmv(A, x.data(), r.data());
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) r[i] = b[i] - r[i];
+        return parallel_norm2(r);
+    };
+
+    double beta = residual_into();
+    result.relativeResidual = beta / bnorm;
+    while (result.relativeResidual > opts.tolerance && result.iterations < opts.maxIterations) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) V[0][i] = r[i] / beta;
+        fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        int j = 0;
+        for (; j < m && result.iterations < opts.maxIterations; ++j) {
+            ++result.iterations;
+            apply_preconditioner(M, V[j], z);
+            csr_spmv(A, z.data(), w.data());
+
+            // Modified Gram-Schmidt against the current basis
+            for (int i = 0; i <= j; ++i) {
+                double h = parallel_dot(w, V[i]);
+                H[size_t(j) * (m + 1) + i] = h;
+                #pragma omp parallel for schedule(static)
+                for (int t = 0; t < n; ++t) w[t] -= h * V[i][t];
+            }
+            double hNext = parallel_norm2(w);
+            H[size_t(j) * (m + 1) + j + 1] = hNext;
+            if (hNext > 0.0) {
+                #pragma omp parallel for schedule(static)
+                for (int t = 0; t < n; ++t) V[j + 1][t] = w[t] / hNext;
+            }
+
+            // Apply the previous Givens rotations, then annihilate H(j+1, j)
+            double* column = &H[size_t(j) * (m + 1)];
+            for (int i = 0; i < j; ++i) {
+                double temp = cs[i] * column[i] + sn[i] * column[i + 1];
+                column[i + 1] = -sn[i] * column[i] + cs[i] * column[i + 1];
+                column[i] = temp;
+            }
+            double denom = hypot(column[j], column[j + 1]);
+            cs[j] = denom > 0.0 ? column[j] / denom : 1.0;
+            sn[j] = denom > 0.0 ? column[j + 1] / denom : 0.0;
+            column[j] = denom;
+            column[j + 1] = 0.0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+
+            result.relativeResidual = fabs(g[j + 1]) / bnorm;
+            if (result.relativeResidual <= opts.tolerance || hNext == 0.0) { ++j; break; }
+        }
+
+        // Back-substitute the small triangular system and update x += M^{-1} V y
+        for (int i = j - 1; i >= 0; --i) {
+            double s = g[i];
+            for (int k = i + 1; k < j; ++k) s -= H[size_t(k) * (m + 1) + i] * y[k];
+            y[i] = s / H[size_t(i) * (m + 1) + i];
+        }
+        fill(w.begin(), w.end(), 0.0);
+        for (int i = 0; i < j; ++i) {
+            #pragma omp parallel for schedule(static)
+            for (int t = 0; t < n; ++t) w[t] += y[i] * V[i][t];
+        }
+        apply_preconditioner(M, w, z);
+        #pragma omp parallel for schedule(static)
+        for (int t = 0; t < n; ++t) x[t] += z[t];
+
+        beta = residual_into();
+        result.relativeResidual = beta / bnorm;
+        if (beta == 0.0) break;
+    }
+    result.converged = result.relativeResidual <= opts.tolerance;
+    return result;
+}
+
+static KrylovResult solve_bicgstab(const CompressedSparseRowMatrix& A, const IncompleteLUPreconditioner* M,
+                                   const vector<double>& b, vector<double>& x, const KrylovOptions& opts) {
+    int n = A.numberOfRows;
+    KrylovResult result;
+    x.assign(n, 0.0);
+
+    double bnorm = parallel_norm2(b);
+    if (bnorm == 0.0) { result.converged = true; return result; }
+
+    vector<double> r(b), rHat(b), p(n, 0.0), v(n, 0.0), s(n), t(n), pHat(n), sHat(n);
+    double rho = 1.0, alpha = 1.0, omega = 1.0;
+    result.relativeResidual = 1.0;
+
+    while (result.relativeResidual > opts.tolerance && result.iterations < opts.maxIterations) {
+        ++result.iterations;
+        double rhoNext = parallel_dot(rHat, r);
+        if (rhoNext == 0.0) break;  // breakdown: shadow residual orthogonal to r
+        double beta = (rhoNext / rho) * (alpha / omega);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+        apply_preconditioner(M, p, pHat);
+        csr_spmv(A, pHat.data(), v.data());
+        alpha = rhoNext / parallel_dot(rHat, v);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) s[i] = r[i] - alpha * v[i];
+
+        double snorm = parallel_norm2(s);
+        if (snorm / bnorm <= opts.tolerance) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; ++i) x[i] += alpha * pHat[i];
+            result.relativeResidual = snorm / bnorm;
+            break;
+        }
+
+        apply_preconditioner(M, s, sHat);
+        csr_spmv(A, sHat.data(), t.data());
+        double tt = parallel_dot(t, t);
+        omega = tt > 0.0 ? parallel_dot(t, s) / tt : 0.0;
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) {
+            x[i] += alpha * pHat[i] + omega * sHat[i];
+            r[i] = s[i] - omega * t[i];
+        }
+        result.relativeResidual = parallel_norm2(r) / bnorm;
+        rho = rhoNext;
+        if (omega == 0.0) break;
+    }
+    result.converged = result.relativeResidual <= opts.tolerance;
+    return result;
+}
+
+// ============================================================================
+// Banded Path: bandwidth detection, blocked band LU, partitioned tridiagonal
+// ============================================================================
+
+struct Bandwidth {
+    int lower;  // kl: max(i - j) over stored entries
+    int upper;  // ku: max(j - i) over stored entries
+};
+
+static Bandwidth detect_bandwidth(const vector<CoordinateEntry>& coo) {
+    Bandwidth bw = {0, 0};
+    for (const auto &e : coo) {
+        if (e.value == 0.0) continue;
+        bw.lower = max(bw.lower, e.row - e.column);
+        bw.upper = max(bw.upper, e.column - e.row);
+    }
+    return bw;
+}
+
+/**
+ * @brief LAPACK-style band storage (column-major) with kl extra superdiagonals for pivoting fill
+ *
+ * Element A(i,j) lives at ab[j * ldab + kl + ku + i - j] for j - kl - ku <= i <= j + kl.
+ */
+struct BandMatrix {
+    int n = 0;
+    int kl = 0;
+    int ku = 0;
+    int ldab = 0;
+    vector<double> ab;
+
+    BandMatrix() = default;
+    BandMatrix(int order, int lower, int upper)
+        : n(order), kl(lower), ku(upper), ldab(2 * lower + upper + 1),
+          ab(size_t(order) * size_t(2 * lower + upper + 1), 0.0) {}
+
+    double& at(int i, int j) { return ab[size_t(j) * size_t(ldab) + size_t(kl + ku + i - j)]; }
+    double at(int i, int j) const { return ab[size_t(j) * size_t(ldab) + size_t(kl + ku + i - j)]; }
+};
+
+static BandMatrix coo_to_band(int n, Bandwidth bw, const vector<CoordinateEntry>& coo) {
+    BandMatrix band(n, bw.lower, bw.upper);
+    for (const auto &e : coo) {
+        if (e.row < 0 || e.column < 0 || e.row >= n || e.column >= n) continue;
+        if (e.row - e.column > bw.lower || e.column - e.row > bw.upper) continue;
+        band.at(e.row, e.column) += e.value;
+    }
+    return band;
+}
+
+/**
+ * @brief Blocked band LU with partial pivoting (dgbtrf-style, L kept unpermuted)
+ *
+ * Each panel of blockSize columns is factorised with its row swaps applied to the
+ * panel only; the trailing columns reached by the panel (at most kl + ku of them)
+ * then receive all of the panel's swaps and eliminations in one pass per column,
+ * in parallel across columns.
+ */
+static bool factorize_band_lu(BandMatrix& A, vector<int>& ipiv, int blockSize = 32) {
+    int n = A.n, kl = A.kl, kv = A.kl + A.ku;
+    ipiv.assign(n, 0);
+
+    for (int j0 = 0; j0 < n; j0 += blockSize) {
+        int j1 = min(n, j0 + blockSize);
+
+        // Panel factorisation
+        for (int c = j0; c < j1; ++c) {
+            int lastRow = min(n - 1, c + kl);
+            int piv = c;
+            double maxval = fabs(A.at(c, c));
+            for (int i = c + 1; i <= lastRow; ++i) {
+                double v = fabs(A.at(i, c));
+                if (v > maxval) { maxval = v; piv = i; }
+            }
+            if (maxval < 1e-15) return false;
+            ipiv[c] = piv;
+
+            int lastColumn = min(j1 - 1, c + kv);
+            if (piv != c) {
+                for (int t = c; t <= lastColumn; ++t) std::swap(A.at(c, t), A.at(piv, t));
+            }
+            double inversePivot = 1.0 / A.at(c, c);
+            for (int i = c + 1; i <= lastRow; ++i) A.at(i, c) *= inversePivot;
+            for (int t = c + 1; t <= lastColumn; ++t) {
+                double ukt = A.at(c, t);
+                if (ukt == 0.0) continue;
+                for (int i = c + 1; i <= lastRow; ++i) A.at(i, t) -= A.at(i, c) * ukt;
+            }
+        }
+
+        // Trailing columns touched by this panel: swaps then eliminations, column by column
+        int trailingEnd = min(n - 1, j1 - 1 + kv);
+        #pragma omp parallel for schedule(static) if (trailingEnd - j1 > 64)
+        for (int t = j1; t <= trailingEnd; ++t) {
+            for (int c = max(j0, t - kv); c < j1; ++c) {
+                int piv = ipiv[c];
+                if (piv != c) std::swap(A.at(c, t), A.at(piv, t));
+                double ukt = A.at(c, t);
+                if (ukt == 0.0) continue;
+                int lastRow = min(n - 1, c + kl);
+                for (int i = c + 1; i <= lastRow; ++i) A.at(i, t) -= A.at(i, c) * ukt;
+            }
+        }
+    }
+    return true;
+}
+
+// Solve with the factors from factorize_band_lu; x holds b on entry
+static void solve_band_lu(const BandMatrix& LU, const vector<int>& ipiv, vector<double>& x) {
+    int n = LU.n, kl = LU.kl, kv = LU.kl + LU.ku;
+    for (int c = 0; c < n; ++c) {
+        if (ipiv[c] != c) std::swap(x[c], x[ipiv[c]]);
+        int lastRow = min(n - 1, c + kl);
+        for (int i = c + 1; i <= lastRow; ++i) x[i] -= LU.at(i, c) * x[c];
+    }
+    for (int j = n - 1; j >= 0; --j) {
+        x[j] /= LU.at(j, j);
+        for (int i = max(0, j - kv); i < j; ++i) x[i] -= LU.at(i, j) * x[j];
+    }
+}
+
+/**
+ * @brief Partitioned (SPIKE-style) tridiagonal solver
+ *
+ * Each partition is eliminated independently by the Thomas algorithm against three
+ * right-hand sides: the local b and the two coupling spikes. The 2P boundary unknowns
+ * form a small pentadiagonal system (solved with the band LU), after which every
+ * partition recovers its interior in parallel. No pivoting: callers must check
+ * diagonal dominance first.
+ *
+ * @param sub  sub[i] = A(i, i-1), sub[0] ignored
+ * @param diag diag[i] = A(i, i)
+ * @param sup  sup[i] = A(i, i+1), sup[n-1] ignored
+ */
+static bool solve_tridiagonal_partitioned(const vector<double>& sub, const vector<double>& diag,
+                                          const vector<double>& sup, const vector<double>& rhs,
+                                          vector<double>& x, int numPartitions) {
+    int n = int(diag.size());
+    int P = max(1, min(numPartitions, n / 2));
+    vector<int> starts(P + 1);
+    for (int k = 0; k <= P; ++k) starts[k] = int((long long)n * k / P);
+
+    vector<double> y(n), v(n, 0.0), w(n, 0.0), scratch(n);
+    bool ok = true;
+
+    #pragma omp parallel for schedule(static, 1) num_threads(P) reduction(&&:ok)
+    for (int k = 0; k < P; ++k) {
+        int s = starts[k], e = starts[k + 1];
+        // Forward sweep: scratch holds the modified superdiagonal
+        double denom = diag[s];
+        if (fabs(denom) < 1e-15) { ok = false; continue; }
+        scratch[s] = (s + 1 < e) ? sup[s] / denom : 0.0;
+        y[s] = rhs[s] / denom;
+        v[s] = (s > 0) ? sub[s] / denom : 0.0;
+        w[s] = (s + 1 == e && e < n) ? sup[s] / denom : 0.0;
+        for (int i = s + 1; i < e; ++i) {
+            denom = diag[i] - sub[i] * scratch[i - 1];
+            if (fabs(denom) < 1e-15) { ok = false; break; }
+            scratch[i] = (i + 1 < e) ? sup[i] / denom : 0.0;
+            y[i] = (rhs[i] - sub[i] * y[i - 1]) / denom;
+            v[i] = (0.0 - sub[i] * v[i - 1]) / denom;
+            w[i] = ((i + 1 == e && e < n) ? sup[i] : 0.0) / denom - sub[i] * w[i - 1] / denom;
+        }
+        if (!ok) continue;
+        // Backward sweep
+        for (int i = e - 2; i >= s; --i) {
+            y[i] -= scratch[i] * y[i + 1];
+            v[i] -= scratch[i] * v[i + 1];
+            w[i] -= scratch[i] * w[i + 1];
+        }
+    }
+    if (!ok) return false;
+
+    // Reduced system on (first, last) unknowns of every partition
+    int m = 2 * P;
+    BandMatrix reduced(m, 2, 2);
+    vector<double> boundary(m);
+    for (int k = 0; k < P; ++k) {
+        int s = starts[k], last = starts[k + 1] - 1;
+        int rf = 2 * k, rl = 2 * k + 1;
+        reduced.at(rf, rf) = 1.0;
+        reduced.at(rl, rl) = 1.0;
+        if (k > 0) {
+            reduced.at(rf, rf - 1) = v[s];
+            reduced.at(rl, rf - 1) = v[last];
+        }
+        if (k + 1 < P) {
+            reduced.at(rf, rl + 1) = w[s];
+            reduced.at(rl, rl + 1) = w[last];
+        }
+        boundary[rf] = y[s];
+        boundary[rl] = y[last];
+    }
+    vector<int> ipiv;
+    if (!factorize_band_lu(reduced, ipiv)) return false;
+    solve_band_lu(reduced, ipiv, boundary);
+
+    x.assign(n, 0.0);
+    #pragma omp parallel for schedule(static, 1) num_threads(P)
+    for (int k = 0; k < P; ++k) {
+        double left = k > 0 ? boundary[2 * k - 1] : 0.0;
+        double right = k + 1 < P ? boundary[2 * k + 2] : 0.0;
+        for (int i = starts[k]; i < starts[k + 1]; ++i) x[i] = y[i] - v[i] * left - w[i] * right;
+    }
+    return true;
+}
+
+// Strict row diagonal dominance makes pivot-free elimination safe for the tridiagonal path
+static bool is_tridiagonal_dominant(const vector<double>& sub, const vector<double>& diag, const vector<double>& sup) {
+    int n = int(diag.size());
+    for (int i = 0; i < n; ++i) {
+        double off = (i > 0 ? fabs(sub[i]) : 0.0) + (i + 1 < n ? fabs(sup[i]) : 0.0);
+        if (fabs(diag[i]) <= off) return false;
+    }
+    return true;
+}
+
+// Band storage pays off once the stored band (with fill room) is a small fraction of n
+static bool band_path_pays_off(int n, Bandwidth bw) {
+    return 4LL * (2LL * bw.lower + bw.upper + 1) <= n;
+}
+
+static int run_banded_solver(int n, const vector<CoordinateEntry>& coo, Bandwidth bw) {
+    CompressedSparseRowMatrix csr = coo_to_csr(n, n, coo);
+    vector<double> b = generate_random_b(n, 1337);
+    vector<double> x;
+
+    if (bw.lower <= 1 && bw.upper <= 1) {
+        vector<double> sub(n, 0.0), diag(n, 0.0), sup(n, 0.0);
+        for (const auto &e : coo) {
+            if (e.row < 0 || e.column < 0 || e.row >= n || e.column >= n) continue;
+            if (e.row == e.column) diag[e.row] += e.value;
+            else if (e.row == e.column + 1) sub[e.row] += e.value;
+            else if (e.column == e.row + 1) sup[e.row] += e.value;
+        }
+        if (is_tridiagonal_dominant(sub, diag, sup)) {
+            int partitions = omp_get_max_threads();
+            cout << "Path: partitioned tridiagonal solver (" << max(1, min(partitions, n / 2))
+                 << " partitions)" << endl;
+            auto t0 = chrono::high_resolution_clock::now();
+            bool ok = solve_tridiagonal_partitioned(sub, diag, sup, b, x, partitions);
+            auto t1 = chrono::high_resolution_clock::now();
+            if (!ok) {
+                cerr << "Tridiagonal solver failed (zero pivot)" << endl;
+                return 1;
+            }
+            print_solve_report("Tridiagonal", chrono::duration<double, milli>(t1 - t0).count(),
+                               compute_residual(csr, x, b));
+            return 0;
+        }
+        cout << "Tridiagonal matrix is not diagonally dominant, using pivoting band LU" << endl;
+    }
+
+    cout << "Path: blocked band LU (band storage " << (2 * bw.lower + bw.upper + 1) << " x " << n << ")" << endl;
+    auto t0 = chrono::high_resolution_clock::now();
+    BandMatrix band = coo_to_band(n, bw, coo);
+    vector<int> ipiv;
+    bool ok = factorize_band_lu(band, ipiv);
+    if (ok) {
+        x = b;
+        solve_band_lu(band, ipiv, x);
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    if (!ok) {
+        cerr << "Band LU failed (singular?)" << endl;
+        return 1;
+    }
+    print_solve_report("Band LU", chrono::duration<double, milli>(t1 - t0).count(), compute_residual(csr, x, b));
+    return 0;
+}
+
+// ============================================================================
+// Low-Rank Updates: Sherman-Morrison-Woodbury on a stored LU factorisation
+// ============================================================================
+
+/**
+ * @brief Solves (A + U V^T) x = b from a stored LU of A instead of refactorising
+ *
+ * With Z = A^{-1} U (n x k) and the capacitance C = I + V^T Z (k x k):
+ *   x = y - Z C^{-1} (V^T y),  y = A^{-1} b.
+ * A rank-k update costs k solves with the stored factors (O(n^2 k)) plus an
+ * O(n k^2 + k^3) capacitance rebuild. Once the update work accumulated since the last
+ * factorisation would exceed the cost of a new one, A + U V^T is formed and refactorised.
+ */
+class UpdatableLUSolver {
+public:
+    bool factorize(int order, const double* A) {
+        n = order;
+        matrix.resize(size_t(n) * size_t(n));
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n; ++j) {
+            copy(A + size_t(j) * size_t(n), A + size_t(j + 1) * size_t(n), matrix.begin() + size_t(j) * size_t(n));
+        }
+        return refactorize();
+    }
+
+    /**
+     * @brief Accumulate a rank-k modification A <- A + U V^T (U, V are n x k, column-major)
+     * @return false if the updated matrix is numerically singular
+     */
+    bool update(const vector<double>& Unew, const vector<double>& Vnew, int k) {
+        double nd = double(n), rank = double(updateRank + k);
+        double updateFlops = 2.0 * nd * nd * k + 2.0 * nd * rank * rank + (2.0 / 3.0) * rank * rank * rank;
+        U.insert(U.end(), Unew.begin(), Unew.begin() + size_t(n) * k);
+        V.insert(V.end(), Vnew.begin(), Vnew.begin() + size_t(n) * k);
+        updateRank += k;
+
+        if (accumulatedUpdateFlops + updateFlops > factorizationFlops()) {
+            lastUpdateRefactorized = true;
+            return refactorize();
+        }
+        lastUpdateRefactorized = false;
+        accumulatedUpdateFlops += updateFlops;
+
+        // Z gains k new columns A^{-1} U_new, one independent solve each
+        size_t oldSize = Z.size();
+        Z.resize(oldSize + size_t(n) * k);
+        #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < k; ++c) {
+            vector<double> column(Unew.begin() + size_t(c) * n, Unew.begin() + size_t(c + 1) * n);
+            solve_dense_lu(factors, column);
+            copy(column.begin(), column.end(), Z.begin() + oldSize + size_t(c) * n);
+        }
+        return rebuildCapacitance();
+    }
+
+    void solve(const vector<double>& b, vector<double>& x) const {
+        x = b;
+        solve_dense_lu(factors, x);
+        if (updateRank == 0) return;
+
+        // w = C^{-1} V^T y, then x = y - Z w
+        vector<double> w(updateRank);
+        #pragma omp parallel for schedule(static)
+        for (int c = 0; c < updateRank; ++c) {
+            const double* v = V.data() + size_t(c) * n;
+            double s = 0.0;
+            for (int i = 0; i < n; ++i) s += v[i] * x[i];
+            w[c] = s;
+        }
+        solve_dense_lu(capacitance, w);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) {
+            double s = 0.0;
+            for (int c = 0; c < updateRank; ++c) s += Z[size_t(c) * n + i] * w[c];
+            x[i] -= s;
+        }
+    }
+
+    int getUpdateRank() const { return updateRank; }
+    int getRefactorizationCount() const { return refactorizations; }
+    bool wasLastUpdateRefactorized() const { return lastUpdateRefactorized; }
+
+private:
+    int n = 0;
+    DenseBuffer matrix;                      // A as of the last factorisation
+    DenseLUFactorization<double> factors;
+    vector<double> U, V, Z;                  // n x updateRank each, column-major
+    int updateRank = 0;
+    DenseLUFactorization<double> capacitance;
+    double accumulatedUpdateFlops = 0.0;
+    int refactorizations = 0;
+    bool lastUpdateRefactorized = false;
+
+    double factorizationFlops() const {
+        return (2.0 / 3.0) * double(n) * double(n) * double(n);
+    }
+
+    // Fold U V^T into the stored matrix and factorise from scratch
+    bool refactorize() {
+        if (updateRank > 0) {
+            #pragma omp parallel for schedule(static)
+            for (int j = 0; j < n; ++j) {
+                double* column = matrix.data() + size_t(j) * size_t(n);
+                for (int c = 0; c < updateRank; ++c) {
+                    double vjc = V[size_t(c) * n + j];
+                    if (vjc == 0.0) continue;
+                    const double* u = U.data() + size_t(c) * n;
+                    for (int i = 0; i < n; ++i) column[i] += u[i] * vjc;
+                }
+            }
+        }
+        U.clear();
+        V.clear();
+        Z.clear();
+        updateRank = 0;
+        accumulatedUpdateFlops = 0.0;
+        ++refactorizations;
+        return factorize_dense_lu(n, matrix.data(), factors);
+    }
+
+    bool rebuildCapacitance() {
+        int k = updateRank;
+        vector<double> C(size_t(k) * k);
+        #pragma omp parallel for schedule(static)
+        for (int c = 0; c < k; ++c) {
+            const double* z = Z.data() + size_t(c) * n;
+            for (int r = 0; r < k; ++r) {
+                const double* v = V.data() + size_t(r) * n;
+                double s = (r == c) ? 1.0 : 0.0;
+                for (int i = 0; i < n; ++i) s += v[i] * z[i];
+                C[size_t(c) * k + r] = s;
+            }
+        }
+        return factorize_dense_lu(k, C.data(), capacitance);
+    }
+};
+
+/**
+ * @brief Re-solve after repeated batches of single-entry changes, Woodbury vs. full refactorisation
+ */
+static void run_low_rank_update_demo(int n, const double* A, int entriesPerRound, int rounds) {
+    UpdatableLUSolver solver;
+    vector<double> b = generate_random_b(n, 1337);
+    if (!solver.factorize(n, A)) {
+        cerr << "Low-rank update: initial factorisation failed (singular?)" << endl;
+        return;
+    }
+
+    DenseBuffer current(size_t(n) * size_t(n));
+    copy(A, A + size_t(n) * size_t(n), current.begin());
+    mt19937 rng(2024);
+    uniform_int_distribution<int> index(0, n - 1);
+    uniform_real_distribution<double> delta(-1.0, 1.0);
+
+    cout << "=== LOW-RANK UPDATES (" << entriesPerRound << " entries per round) ===" << endl;
+    for (int round = 1; round <= rounds; ++round) {
+        // Changing A(i,j) by d is the rank-1 term (d e_i)(e_j)^T
+        vector<double> U(size_t(n) * entriesPerRound, 0.0), V(size_t(n) * entriesPerRound, 0.0);
+        for (int c = 0; c < entriesPerRound; ++c) {
+            int i = index(rng), j = index(rng);
+            double d = delta(rng);
+            U[size_t(c) * n + i] = d;
+            V[size_t(c) * n + j] = 1.0;
+            current[size_t(j) * size_t(n) + i] += d;
+        }
+
+        vector<double> x;
+        auto t0 = chrono::high_resolution_clock::now();
+        bool ok = solver.update(U, V, entriesPerRound);
+        if (ok) solver.solve(b, x);
+        auto t1 = chrono::high_resolution_clock::now();
+        if (!ok) {
+            cerr << "Round " << round << ": updated matrix is singular" << endl;
+            return;
+        }
+        string label = "Round " + to_string(round) + " Woodbury (rank " + to_string(solver.getUpdateRank()) +
+                       (solver.wasLastUpdateRefactorized() ? ", refactorised" : "") + ")";
+        print_solve_report(label, chrono::duration<double, milli>(t1 - t0).count(),
+                           compute_residual_dense(n, current.data(), x, b));
+
+        vector<double> xFull;
+        t0 = chrono::high_resolution_clock::now();
+        bool okFull = solve_dense_cpu_gauss(n, current.data(), b, xFull);
+        t1 = chrono::high_resolution_clock::now();
+        if (okFull) {
+            print_solve_report("Round " + to_string(round) + " full refactorisation",
+                               chrono::duration<double, milli>(t1 - t0).count(),
+                               compute_residual_dense(n, current.data(), xFull, b));
+        }
+    }
+    cout << "Factorisations performed by the updatable solver: " << solver.getRefactorizationCount() << endl;
+}
+
+// ============================================================================
+// HODLR: hierarchically off-diagonal low-rank compression and direct solve
+// ============================================================================
+
+/**
+ * @brief Off-diagonal block stored as B ~= U V^T (U: rows x rank, V: cols x rank, column-major)
+ */
+struct LowRankBlock {
+    int rows = 0;
+    int cols = 0;
+    int rank = 0;
+    vector<double> U;
+    vector<double> V;
+};
+
+/**
+ * @brief Adaptive randomised range finder (Halko, Martinsson, Tropp)
+ *
+ * Samples B in batches of Gaussian vectors, re-orthogonalises against the basis found
+ * so far (twice, classical Gram-Schmidt) and stops once the a-posteriori bound
+ * 10 sqrt(2/pi) max ||(I - Q Q^T) B w|| drops below tol * ||B||_F. V = B^T Q.
+ */
+static LowRankBlock compress_low_rank(const double* B, int ldb, int rows, int cols, double tol, uint64_t seed) {
+    const int batch = 16;
+    LowRankBlock block;
+    block.rows = rows;
+    block.cols = cols;
+
+    double normB = 0.0;
+    for (int j = 0; j < cols; ++j) {
+        for (int i = 0; i < rows; ++i) normB += B[size_t(j) * ldb + i] * B[size_t(j) * ldb + i];
+    }
+    normB = sqrt(normB);
+    if (normB == 0.0) return block;
+
+    mt19937_64 rng(seed);
+    normal_distribution<double> gaussian(0.0, 1.0);
+    int maxRank = min(rows, cols);
+    vector<double>& Q = block.U;
+    vector<double> omega(size_t(cols) * batch), Y(size_t(rows) * batch), coefficients(batch);
+
+    while (block.rank < maxRank) {
+        for (double& w : omega) w = gaussian(rng);
+        fill(Y.begin(), Y.end(), 0.0);
+        for (int j = 0; j < cols; ++j) {
+            const double* bj = B + size_t(j) * ldb;
+            for (int q = 0; q < batch; ++q) {
+                double w = omega[size_t(q) * cols + j];
+                double* yq = Y.data() + size_t(q) * rows;
+                for (int i = 0; i < rows; ++i) yq[i] += bj[i] * w;
+            }
+        }
+
+        // Project out the current basis; the residual norms drive the stopping test
+        double maxResidual = 0.0;
+        for (int q = 0; q < batch; ++q) {
+            double* yq = Y.data() + size_t(q) * rows;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int c = 0; c < block.rank; ++c) {
+                    const double* qc = Q.data() + size_t(c) * rows;
+                    double d = 0.0;
+                    for (int i = 0; i < rows; ++i) d += qc[i] * yq[i];
+                    for (int i = 0; i < rows; ++i) yq[i] -= d * qc[i];
+                }
+            }
+            double norm = 0.0;
+            for (int i = 0; i < rows; ++i) norm += yq[i] * yq[i];
+            maxResidual = max(maxResidual, sqrt(norm));
+        }
+        if (10.0 * sqrt(2.0 / M_PI) * maxResidual <= tol * normB) break;
+
+        // Orthonormalise the batch among itself and append it
+        int rankBefore = block.rank;
+        for (int q = 0; q < batch && block.rank < maxRank; ++q) {
+            double* yq = Y.data() + size_t(q) * rows;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int c = 0; c < block.rank; ++c) {
+                    const double* qc = Q.data() + size_t(c) * rows;
+                    double d = 0.0;
+                    for (int i = 0; i < rows; ++i) d += qc[i] * yq[i];
+                    for (int i = 0; i < rows; ++i) yq[i] -= d * qc[i];
+                }
+            }
+            double norm = 0.0;
+            for (int i = 0; i < rows; ++i) norm += yq[i] * yq[i];
+            norm = sqrt(norm);
+            if (norm <= 1e-14 * normB) continue;
+            Q.resize(Q.size() + rows);
+            double* qNew = Q.data() + size_t(block.rank) * rows;
+            for (int i = 0; i < rows; ++i) qNew[i] = yq[i] / norm;
+            ++block.rank;
+        }
+        // Every new direction fell below round-off: the basis already spans the block numerically
+        if (block.rank == rankBefore) break;
+    }
+
+    block.V.assign(size_t(cols) * block.rank, 0.0);
+    for (int j = 0; j < cols; ++j) {
+        const double* bj = B + size_t(j) * ldb;
+        for (int c = 0; c < block.rank; ++c) {
+            const double* qc = Q.data() + size_t(c) * rows;
+            double d = 0.0;
+            for (int i = 0; i < rows; ++i) d += qc[i] * bj[i];
+            block.V[size_t(c) * cols + j] = d;
+        }
+    }
+    return block;
+}
+
+/**
+ * @brief HODLR matrix with a recursive Woodbury factorisation
+ *
+ * Every internal node splits its range in two: A = [A11, U1 V2^T; U2 V1^T, A22].
+ * With D = diag(A11, A22), Y1 = A11^{-1} U1, Y2 = A22^{-1} U2 and
+ * K = [I, V2^T Y2; V1^T Y1, I], the solve is x = D^{-1} b - [Y1 s1; Y2 s2],
+ * s = K^{-1} [V2^T y2; V1^T y1]. Leaves hold a dense LU. Children are independent,
+ * so compression, factorisation and solves run as OpenMP tasks over the tree.
+ */
+class HODLRSolver {
+public:
+    bool build(int order, const double* A, int leafSize, double tolerance) {
+        n = order;
+        nodes.clear();
+        nodes.reserve(size_t(4) * max(1, n / max(1, leafSize)) + 1);
+        createNode(0, n, leafSize);
+        bool ok = true;
+        #pragma omp parallel
+        #pragma omp single
+        ok = compressAndFactorize(0, A, tolerance);
+        return ok;
+    }
+
+    void solve(const vector<double>& b, vector<double>& x) const {
+        x = b;
+        #pragma omp parallel
+        #pragma omp single
+        solveNode(0, x.data(), n, 1);
+    }
+
+    // Doubles held by leaves, low-rank factors, the Y = D^{-1} U blocks and the capacitance LUs
+    size_t getStoredDoubles() const {
+        size_t total = 0;
+        for (const auto& node : nodes) {
+            if (node.left < 0) {
+                total += size_t(node.size) * size_t(node.size);
+            } else {
+                total += node.upper.U.size() + node.upper.V.size() + node.lower.U.size() + node.lower.V.size();
+                total += node.solvedUpper.size() + node.solvedLower.size() + node.capacitance.lu.size();
+            }
+        }
+        return total;
+    }
+
+    int getMaxRank() const {
+        int r = 0;
+        for (const auto& node : nodes) r = max(r, max(node.upper.rank, node.lower.rank));
+        return r;
+    }
+
+    int getDepth() const { return depth; }
+
+private:
+    struct Node {
+        int begin = 0;
+        int size = 0;
+        int left = -1;
+        int right = -1;
+        DenseLUFactorization<double> leafLU;
+        LowRankBlock upper;            // A12 ~= U1 V2^T
+        LowRankBlock lower;            // A21 ~= U2 V1^T
+        vector<double> solvedUpper;    // Y1 = A11^{-1} U1
+        vector<double> solvedLower;    // Y2 = A22^{-1} U2
+        DenseLUFactorization<double> capacitance;
+    };
+
+    int n = 0;
+    int depth = 0;
+    vector<Node> nodes;
+
+    int createNode(int begin, int size, int leafSize, int level = 0) {
+        int index = int(nodes.size());
+        nodes.emplace_back();
+        nodes[index].begin = begin;
+        nodes[index].size = size;
+        depth = max(depth, level);
+        if (size > leafSize) {
+            int half = size / 2;
+            int left = createNode(begin, half, leafSize, level + 1);
+            int right = createNode(begin + half, size - half, leafSize, level + 1);
+            nodes[index].left = left;
+            nodes[index].right = right;
+        }
+        return index;
+    }
+
+    bool compressAndFactorize(int index, const double* A, double tolerance) {
+        Node& node = nodes[index];
+        if (node.left < 0) {
+            vector<double> block(size_t(node.size) * node.size);
+            for (int j = 0; j < node.size; ++j) {
+                const double* column = A + size_t(node.begin + j) * size_t(n) + node.begin;
+                copy(column, column + node.size, block.begin() + size_t(j) * node.size);
+            }
+            return factorize_dense_lu(node.size, block.data(), node.leafLU);
+        }
+
+        // Plain ints for the tasks: a reference local would be captured firstprivate,
+        // i.e. the child Node copied while its own task is still writing it
+        const int left = node.left, right = node.right;
+        const int leftBegin = nodes[left].begin, leftSize = nodes[left].size;
+        const int rightBegin = nodes[right].begin, rightSize = nodes[right].size;
+        bool okLeft = true, okRight = true;
+        bool spawn = node.size > 512;
+        #pragma omp task shared(okLeft) if (spawn)
+        okLeft = compressAndFactorize(left, A, tolerance);
+        #pragma omp task shared(okRight) if (spawn)
+        okRight = compressAndFactorize(right, A, tolerance);
+        #pragma omp task shared(node) if (spawn)
+        node.upper = compress_low_rank(A + size_t(rightBegin) * size_t(n) + leftBegin, n, leftSize, rightSize,
+                                       tolerance, uint64_t(index) * 2 + 1);
+        #pragma omp task shared(node) if (spawn)
+        node.lower = compress_low_rank(A + size_t(leftBegin) * size_t(n) + rightBegin, n, rightSize, leftSize,
+                                       tolerance, uint64_t(index) * 2 + 2);
+        #pragma omp taskwait
+        if (!okLeft || !okRight) return false;
+
+        // Y1 = A11^{-1} U1, Y2 = A22^{-1} U2 with the children's factorisations
+        node.solvedUpper = node.upper.U;
+        node.solvedLower = node.lower.U;
+        #pragma omp task shared(node) if (spawn)
+        solveNode(left, node.solvedUpper.data(), leftSize, node.upper.rank);
+        #pragma omp task shared(node) if (spawn)
+        solveNode(right, node.solvedLower.data(), rightSize, node.lower.rank);
+        #pragma omp taskwait
+
+        const Node& L = nodes[left];
+        const Node& R = nodes[right];
+
+        int r1 = node.upper.rank, r2 = node.lower.rank, r = r1 + r2;
+        if (r == 0) return true;
+        vector<double> K(size_t(r) * r, 0.0);
+        for (int i = 0; i < r; ++i) K[size_t(i) * r + i] = 1.0;
+        // Top-right block: V2^T Y2 (r1 x r2); bottom-left block: V1^T Y1 (r2 x r1)
+        for (int c = 0; c < r2; ++c) {
+            for (int q = 0; q < r1; ++q) {
+                K[size_t(r1 + c) * r + q] = dotColumns(node.upper.V.data() + size_t(q) * R.size,
+                                                       node.solvedLower.data() + size_t(c) * R.size, R.size);
+            }
+        }
+        for (int c = 0; c < r1; ++c) {
+            for (int q = 0; q < r2; ++q) {
+                K[size_t(c) * r + r1 + q] = dotColumns(node.lower.V.data() + size_t(q) * L.size,
+                                                       node.solvedUpper.data() + size_t(c) * L.size, L.size);
+            }
+        }
+        return factorize_dense_lu(r, K.data(), node.capacitance);
+    }
+
+    // In-place solve of the node's block for nrhs columns of B (leading dimension ldb)
+    void solveNode(int index, double* B, int ldb, int nrhs) const {
+        const Node& node = nodes[index];
+        if (node.left < 0) {
+            for (int c = 0; c < nrhs; ++c) solve_dense_lu(node.leafLU, B + size_t(c) * ldb);
+            return;
+        }
+        // Only ints go into the tasks, so no Node is copied per spawn
+        const int left = node.left, right = node.right, leftSize = nodes[left].size;
+        bool spawn = node.size > 512;
+        #pragma omp task if (spawn)
+        solveNode(left, B, ldb, nrhs);
+        #pragma omp task if (spawn)
+        solveNode(right, B + leftSize, ldb, nrhs);
+        #pragma omp taskwait
+
+        const Node& L = nodes[left];
+        const Node& R = nodes[right];
+
+        int r1 = node.upper.rank, r2 = node.lower.rank, r = r1 + r2;
+        if (r == 0) return;
+        vector<double> s(r);
+        for (int c = 0; c < nrhs; ++c) {
+            double* b1 = B + size_t(c) * ldb;
+            double* b2 = b1 + L.size;
+            for (int q = 0; q < r1; ++q) s[q] = dotColumns(node.upper.V.data() + size_t(q) * R.size, b2, R.size);
+            for (int q = 0; q < r2; ++q) s[r1 + q] = dotColumns(node.lower.V.data() + size_t(q) * L.size, b1, L.size);
+            solve_dense_lu(node.capacitance, s.data());
+            for (int q = 0; q < r1; ++q) {
+                const double* y = node.solvedUpper.data() + size_t(q) * L.size;
+                for (int i = 0; i < L.size; ++i) b1[i] -= y[i] * s[q];
+            }
+            for (int q = 0; q < r2; ++q) {
+                const double* y = node.solvedLower.data() + size_t(q) * R.size;
+                for (int i = 0; i < R.size; ++i) b2[i] -= y[i] * s[r1 + q];
+            }
+        }
+    }
+
+    static double dotColumns(const double* a, const double* b, int length) {
+        double s = 0.0;
+        for (int i = 0; i < length; ++i) s += a[i] * b[i];
+        return s;
+    }
+};
+
+/**
+ * @brief Compress, factorise and solve in HODLR form and compare against the dense LU
+ */
+static void run_hodlr_comparison(int n, const double* A, int leafSize, double tolerance,
+                                 const function<ResidualReport(const vector<double>&, const vector<double>&)>& verify) {
+    vector<double> b = generate_random_b(n, 1337);
+    cout << "=== HODLR (leaf " << leafSize << ", tol " << tolerance << ") ===" << endl;
+
+    auto t0 = chrono::high_resolution_clock::now();
+    DenseLUFactorization<double> dense;
+    bool okDense = factorize_dense_lu(n, A, dense);
+    vector<double> xDense = b;
+    if (okDense) solve_dense_lu(dense, xDense);
+    auto t1 = chrono::high_resolution_clock::now();
+    double denseMs = chrono::duration<double, milli>(t1 - t0).count();
+
+    HODLRSolver hodlr;
+    t0 = chrono::high_resolution_clock::now();
+    bool ok = hodlr.build(n, A, leafSize, tolerance);
+    t1 = chrono::high_resolution_clock::now();
+    if (!ok) {
+        cerr << "HODLR factorisation failed (singular diagonal block?)" << endl;
+        return;
+    }
+    vector<double> x;
+    auto t2 = chrono::high_resolution_clock::now();
+    hodlr.solve(b, x);
+    auto t3 = chrono::high_resolution_clock::now();
+
+    double ratio = double(size_t(n) * size_t(n)) / double(max<size_t>(1, hodlr.getStoredDoubles()));
+    cout << "Tree depth: " << hodlr.getDepth() << ", max off-diagonal rank: " << hodlr.getMaxRank()
+         << ", compression ratio (n^2 / all stored doubles): " << ratio << "x" << endl;
+    cout << "HODLR compress+factorise (ms): " << chrono::duration<double, milli>(t1 - t0).count()
+         << ", solve (ms): " << chrono::duration<double, milli>(t3 - t2).count() << endl;
+    print_solve_report("HODLR", chrono::duration<double, milli>(t3 - t0).count(), verify(x, b));
+    if (okDense) {
+        double diff = 0.0, ref = 0.0;
+        for (int i = 0; i < n; ++i) {
+            diff += (x[i] - xDense[i]) * (x[i] - xDense[i]);
+            ref += xDense[i] * xDense[i];
+        }
+        print_solve_report("Dense LU", denseMs, verify(xDense, b));
+        cout << "HODLR vs dense LU relative difference: " << sqrt(diff / max(ref, 1e-300)) << endl;
+    }
+}
+
+// ============================================================================
+// Least Squares: blocked Householder QR (compact WY) and TSQR
+// ============================================================================
+
+/**
+ * @brief Householder QR factors of an m x n column-major matrix (m >= n)
+ *
+ * R sits on and above the diagonal, the reflector vectors below it (v[0] = 1 implied),
+ * as in LAPACK dgeqrf.
+ */
+struct HouseholderQR {
+    int m = 0;
+    int n = 0;
+    int blockSize = 32;
+    vector<double> qr;
+    vector<double> tau;
+};
+
+// dlarfg: turn x (length len) into beta e1; x[1:] receives v[1:], returns tau
+static double make_householder(int len, double* x) {
+    double alpha = x[0];
+    double tailNorm = 0.0;
+    for (int i = 1; i < len; ++i) tailNorm += x[i] * x[i];
+    if (tailNorm == 0.0) return 0.0;
+    double beta = -copysign(sqrt(alpha * alpha + tailNorm), alpha);
+    double scale = 1.0 / (alpha - beta);
+    for (int i = 1; i < len; ++i) x[i] *= scale;
+    x[0] = beta;
+    return (beta - alpha) / beta;
+}
+
+/**
+ * @brief C <- (I - V T V^T)^T C for the block reflector stored in panel columns [j0, j0+jb)
+ *
+ * W = V^T C, W = T^T W, C -= V W: two matrix products instead of jb rank-1 updates.
+ * Columns of C are independent, so callers split them across threads.
+ */
+static void apply_block_reflector_transposed(int m, const double* A, int lda, int j0, int jb,
+                                             const vector<double>& T, double* C, int ldc, int ncols) {
+    vector<double> W(jb);
+    for (int t = 0; t < ncols; ++t) {
+        double* c = C + size_t(t) * ldc;
+        for (int k = 0; k < jb; ++k) {
+            const double* v = A + size_t(j0 + k) * lda;
+            double s = c[j0 + k];
+            for (int i = j0 + k + 1; i < m; ++i) s += v[i] * c[i];
+            W[k] = s;
+        }
+        // W <- T^T W (T upper triangular, jb x jb)
+        for (int k = jb - 1; k >= 0; --k) {
+            double s = 0.0;
+            for (int q = 0; q <= k; ++q) s += T[size_t(k) * jb + q] * W[q];
+            W[k] = s;
+        }
+        for (int k = 0; k < jb; ++k) {
+            const double* v = A + size_t(j0 + k) * lda;
+            c[j0 + k] -= W[k];
+            for (int i = j0 + k + 1; i < m; ++i) c[i] -= v[i] * W[k];
+        }
+    }
+}
+
+static void factorize_householder_qr(int m, int n, const double* A, int lda, HouseholderQR& F, int blockSize = 32) {
+    F.m = m;
+    F.n = n;
+    F.blockSize = blockSize;
+    F.qr.resize(size_t(m) * size_t(n));
+    F.tau.assign(n, 0.0);
+    for (int j = 0; j < n; ++j) copy(A + size_t(j) * lda, A + size_t(j) * lda + m, F.qr.begin() + size_t(j) * m);
+
+    double* Q = F.qr.data();
+    vector<double> T;
+    for (int j0 = 0; j0 < n; j0 += blockSize) {
+        int jb = min(blockSize, n - j0);
+
+        // Unblocked panel factorisation (dgeqr2)
+        for (int c = j0; c < j0 + jb; ++c) {
+            double* colC = Q + size_t(c) * m;
+            F.tau[c] = make_householder(m - c, colC + c);
+            if (F.tau[c] == 0.0) continue;
+            for (int t = c + 1; t < j0 + jb; ++t) {
+                double* colT = Q + size_t(t) * m;
+                double s = colT[c];
+                for (int i = c + 1; i < m; ++i) s += colC[i] * colT[i];
+                s *= F.tau[c];
+                colT[c] -= s;
+                for (int i = c + 1; i < m; ++i) colT[i] -= s * colC[i];
+            }
+        }
+        if (j0 + jb >= n) break;
+
+        // Triangular factor T of the compact WY form (dlarft, forward columnwise)
+        T.assign(size_t(jb) * jb, 0.0);
+        for (int k = 0; k < jb; ++k) {
+            const double* vk = Q + size_t(j0 + k) * m;
+            for (int q = 0; q < k; ++q) {
+                const double* vq = Q + size_t(j0 + q) * m;
+                double s = vq[j0 + k];  // v_k has an implicit 1 at row j0 + k
+                for (int i = j0 + k + 1; i < m; ++i) s += vq[i] * vk[i];
+                T[size_t(k) * jb + q] = -F.tau[j0 + k] * s;
+            }
+            for (int q = 0; q < k; ++q) {
+                double s = 0.0;
+                for (int p = q; p < k; ++p) s += T[size_t(p) * jb + q] * T[size_t(k) * jb + p];
+                T[size_t(k) * jb + q] = s;
+            }
+            T[size_t(k) * jb + k] = F.tau[j0 + k];
+        }
+
+        const int columnsPerTask = 16;
+        int trailing = n - j0 - jb;
+        int tasks = (trailing + columnsPerTask - 1) / columnsPerTask;
+        #pragma omp parallel for schedule(static) if (tasks > 1)
+        for (int task = 0; task < tasks; ++task) {
+            int t0 = j0 + jb + task * columnsPerTask;
+            apply_block_reflector_transposed(m, Q, m, j0, jb, T, Q + size_t(t0) * m, m,
+                                             min(columnsPerTask, n - t0));
+        }
+    }
+}
+
+// b <- Q^T b, one reflector at a time
+static void apply_qt(const HouseholderQR& F, double* b) {
+    for (int c = 0; c < F.n; ++c) {
+        if (F.tau[c] == 0.0) continue;
+        const double* v = F.qr.data() + size_t(c) * F.m;
+        double s = b[c];
+        for (int i = c + 1; i < F.m; ++i) s += v[i] * b[i];
+        s *= F.tau[c];
+        b[c] -= s;
+        for (int i = c + 1; i < F.m; ++i) b[i] -= s * v[i];
+    }
+}
+
+// Back substitution with the n x n upper triangle R (leading dimension ldr); false if R is rank deficient
+static bool solve_upper_triangular(int n, const double* R, int ldr, double* x) {
+    double maxDiagonal = 0.0;
+    for (int i = 0; i < n; ++i) maxDiagonal = max(maxDiagonal, fabs(R[size_t(i) * ldr + i]));
+    for (int j = n - 1; j >= 0; --j) {
+        double rjj = R[size_t(j) * ldr + j];
+        if (fabs(rjj) <= 1e-14 * maxDiagonal || rjj == 0.0) return false;
+        x[j] /= rjj;
+        for (int i = 0; i < j; ++i) x[i] -= R[size_t(j) * ldr + i] * x[j];
+    }
+    return true;
+}
+
+static bool solve_least_squares_qr(int m, int n, const double* A, const vector<double>& b, vector<double>& x) {
+    HouseholderQR F;
+    factorize_householder_qr(m, n, A, m, F);
+    vector<double> c(b);
+    apply_qt(F, c.data());
+    x.assign(c.begin(), c.begin() + n);
+    return solve_upper_triangular(n, F.qr.data(), m, x.data());
+}
+
+/**
+ * @brief Tall-skinny QR least squares with a binary reduction tree across threads
+ *
+ * Each thread QR-factors a contiguous row block and applies its Q^T to the matching
+ * slice of b; pairs of (R, top of Q^T b) are then stacked and re-factorised level by
+ * level until one R remains. Q is never formed.
+ */
+static bool solve_least_squares_tsqr(int m, int n, const double* A, const vector<double>& b, vector<double>& x,
+                                     int numBlocks) {
+    int P = max(1, min(numBlocks, m / max(1, 2 * n)));
+    vector<int> starts(P + 1);
+    for (int k = 0; k <= P; ++k) starts[k] = int((long long)m * k / P);
+
+    // Leaves: R_k (n x n, leading dimension n) and c_k = (Q_k^T b_k)[0:n]
+    vector<vector<double>> R(P), c(P);
+    #pragma omp parallel for schedule(static, 1)
+    for (int k = 0; k < P; ++k) {
+        int rows = starts[k + 1] - starts[k];
+        vector<double> block(size_t(rows) * n);
+        for (int j = 0; j < n; ++j) {
+            const double* column = A + size_t(j) * m + starts[k];
+            copy(column, column + rows, block.begin() + size_t(j) * rows);
+        }
+        HouseholderQR F;
+        factorize_householder_qr(rows, n, block.data(), rows, F);
+        vector<double> local(b.begin() + starts[k], b.begin() + starts[k + 1]);
+        apply_qt(F, local.data());
+        R[k].assign(size_t(n) * n, 0.0);
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i <= j; ++i) R[k][size_t(j) * n + i] = F.qr[size_t(j) * rows + i];
+        }
+        c[k].assign(local.begin(), local.begin() + n);
+    }
+
+    // Reduction tree: combine (R_a, c_a) and (R_b, c_b) into one pair per level
+    for (int stride = 1; stride < P; stride *= 2) {
+        #pragma omp parallel for schedule(static, 1)
+        for (int a = 0; a < P - stride; a += 2 * stride) {
+            int bIndex = a + stride;
+            vector<double> stacked(size_t(2 * n) * n, 0.0);
+            for (int j = 0; j < n; ++j) {
+                for (int i = 0; i <= j; ++i) {
+                    stacked[size_t(j) * 2 * n + i] = R[a][size_t(j) * n + i];
+                    stacked[size_t(j) * 2 * n + n + i] = R[bIndex][size_t(j) * n + i];
+                }
+            }
+            HouseholderQR F;
+            factorize_householder_qr(2 * n, n, stacked.data(), 2 * n, F);
+            vector<double> rhs(c[a]);
+            rhs.insert(rhs.end(), c[bIndex].begin(), c[bIndex].end());
+            apply_qt(F, rhs.data());
+            for (int j = 0; j < n; ++j) {
+                for (int i = 0; i <= j; ++i) R[a][size_t(j) * n + i] = F.qr[size_t(j) * 2 * n + i];
+            }
+            c[a].assign(rhs.begin(), rhs.begin() + n);
+        }
+    }
+
+    x = c[0];
+    return solve_upper_triangular(n, R[0].data(), n, x.data());
+}
+
+// ============================================================================
+// Least Squares: sketch-and-precondition LSQR (Blendenpik / LSRN style)
+// ============================================================================
+
+struct SketchOptions {
+    double oversampling = 4.0;  // sketch rows s = oversampling * n
+    int nonZerosPerRow = 8;     // sketch rows each row of A is hashed into
+    int maxIterations = 200;
+    double tolerance = 1e-12;   // on ||Abar^T r|| / (||Abar|| ||r||)
+};
+
+struct SketchSolveResult {
+    bool ok = false;
+    bool converged = false;
+    int iterations = 0;
+    double sketchMs = 0.0;
+    double qrMs = 0.0;
+    double lsqrMs = 0.0;
+};
+
+// splitmix64: stateless hash, so every thread derives the same embedding
+static uint64_t mix_hash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Sparse-embedding sketch SA (s x n, column-major) computed from A^T in CSR form
+ *
+ * Row i of A is added to zeta pseudo-random rows of SA with random signs / sqrt(zeta).
+ * Each column of SA only depends on the matching row of A^T, so threads split the
+ * columns and never write the same entry. Cost O(nnz * zeta).
+ */
+static vector<double> sparse_embedding_sketch(const CompressedSparseRowMatrix& AT, int sketchRows, int zeta) {
+    int n = AT.numberOfRows;
+    vector<double> SA(size_t(sketchRows) * n, 0.0);
+    double scale = 1.0 / sqrt(double(zeta));
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int j = 0; j < n; ++j) {
+        double* column = SA.data() + size_t(j) * sketchRows;
+        for (int k = AT.rowPointers[j]; k < AT.rowPointers[j + 1]; ++k) {
+            uint64_t i = uint64_t(AT.columnIndices[k]);
+            double a = AT.values[k] * scale;
+            for (int q = 0; q < zeta; ++q) {
+                uint64_t h = mix_hash(mix_hash(i) + uint64_t(q));
+                int target = int(h % uint64_t(sketchRows));
+                column[target] += (h >> 63) ? a : -a;
+            }
+        }
+    }
+    return SA;
+}
+
+// x <- R^{-T} x for the n x n upper triangle R (leading dimension ldr)
+static void solve_upper_transposed(int n, const double* R, int ldr, double* x) {
+    for (int j = 0; j < n; ++j) {
+        const double* column = R + size_t(j) * ldr;
+        double s = x[j];
+        for (int i = 0; i < j; ++i) s -= column[i] * x[i];
+        x[j] = s / column[j];
+    }
+}
+
+/**
+ * @brief min ||A x - b|| via LSQR on A R^{-1}, where S A = Q R for a sparse embedding S
+ *
+ * The sketch captures A's column space well enough that A R^{-1} has condition number
+ * O(1), so LSQR converges in a few dozen iterations of O(nnz + n^2) each regardless of
+ * how badly conditioned A is.
+ */
+static SketchSolveResult solve_least_squares_sketched(const CompressedSparseRowMatrix& A,
+                                                      const CompressedSparseRowMatrix& AT,
+                                                      const vector<double>& b, vector<double>& x,
+                                                      const SketchOptions& opts) {
+    int m = A.numberOfRows, n = A.numberOfColumns;
+    SketchSolveResult result;
+    int sketchRows = min(m, max(n + 1, int(opts.oversampling * n)));
+
+    auto t0 = chrono::high_resolution_clock::now();
+    vector<double> SA = sparse_embedding_sketch(AT, sketchRows, max(1, min(opts.nonZerosPerRow, sketchRows)));
+    auto t1 = chrono::high_resolution_clock::now();
+    HouseholderQR F;
+    factorize_householder_qr(sketchRows, n, SA.data(), sketchRows, F);
+    auto t2 = chrono::high_resolution_clock::now();
+    result.sketchMs = chrono::duration<double, milli>(t1 - t0).count();
+    result.qrMs = chrono::duration<double, milli>(t2 - t1).count();
+
+    const double* R = F.qr.data();
+    int ldr = sketchRows;
+    double maxDiagonal = 0.0, minDiagonal = numeric_limits<double>::max();
+    for (int i = 0; i < n; ++i) {
+        maxDiagonal = max(maxDiagonal, fabs(R[size_t(i) * ldr + i]));
+        minDiagonal = min(minDiagonal, fabs(R[size_t(i) * ldr + i]));
+    }
+    if (minDiagonal <= 1e-14 * maxDiagonal) return result;  // sketch (hence A) rank deficient
+
+    // Preconditioned operators: Abar y = A R^{-1} y, Abar^T u = R^{-T} A^T u
+    vector<double> scratchN(n);
+    auto applyA = [&](const vector<double>& y, vector<double>& out) {
+        scratchN = y;
+        solve_upper_triangular(n, R, ldr, scratchN.data());
+        csr_spmv(A, scratchN.data(), out.data());
+    };
+    auto applyAT = [&](const vector<double>& u, vector<double>& out) {
+        csr_spmv(AT, u.data(), out.data());
+        solve_upper_transposed(n, R, ldr, out.data());
+    };
+
+    // LSQR (Paige & Saunders) on the preconditioned problem
+    vector<double> u(b), v(n), w(n), y(n, 0.0), Av(m), ATu(n);
+    double beta = parallel_norm2(u);
+    if (beta == 0.0) { x.assign(n, 0.0); result.ok = result.converged = true; return result; }
+    for (double& value : u) value /= beta;
+    applyAT(u, v);
+    double alpha = parallel_norm2(v);
+    if (alpha == 0.0) { x.assign(n, 0.0); result.ok = result.converged = true; return result; }
+    for (double& value : v) value /= alpha;
+    w = v;
+    double phiBar = beta, rhoBar = alpha, normEstimate = 0.0;
+
+    for (result.iterations = 1; result.iterations <= opts.maxIterations; ++result.iterations) {
+        applyA(v, Av);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < m; ++i) u[i] = Av[i] - alpha * u[i];
+        beta = parallel_norm2(u);
+        if (beta > 0.0) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < m; ++i) u[i] /= beta;
+        }
+        applyAT(u, ATu);
+        for (int i = 0; i < n; ++i) v[i] = ATu[i] - beta * v[i];
+        normEstimate = sqrt(normEstimate * normEstimate + alpha * alpha + beta * beta);
+        alpha = parallel_norm2(v);
+        if (alpha > 0.0) for (double& value : v) value /= alpha;
+
+        double rho = hypot(rhoBar, beta);
+        double c = rhoBar / rho, s = beta / rho;
+        double theta = s * alpha;
+        rhoBar = -c * alpha;
+        double phi = c * phiBar;
+        phiBar = s * phiBar;
+        for (int i = 0; i < n; ++i) {
+            y[i] += (phi / rho) * w[i];
+            w[i] = v[i] - (theta / rho) * w[i];
+        }
+
+        // phiBar = ||r||, phiBar * alpha * |c| = ||Abar^T r||
+        if (phiBar * alpha * fabs(c) <= opts.tolerance * normEstimate * phiBar || alpha == 0.0) {
+            result.converged = true;
+            break;
+        }
+    }
+    result.iterations = min(result.iterations, opts.maxIterations);
+    auto t3 = chrono::high_resolution_clock::now();
+    result.lsqrMs = chrono::duration<double, milli>(t3 - t2).count();
+
+    x = y;
+    solve_upper_triangular(n, R, ldr, x.data());
+    result.ok = true;
+    return result;
+}
+
+// ||A^T r||_2 / (||A||_F ||r||_2): zero at the least-squares optimum
+static double normal_equation_residual(const CompressedSparseRowMatrix& A, const vector<double>& x, const vector<double>& b) {
+    vector<double> r(A.numberOfRows), atr(A.numberOfColumns, 0.0);
+    csr_spmv(A, x.data(), r.data());
+    double normA = 0.0, normR = 0.0;
+    for (int i = 0; i < A.numberOfRows; ++i) {
+        r[i] -= b[i];
+        normR += r[i] * r[i];
+        for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+            atr[A.columnIndices[k]] += A.values[k] * r[i];
+            normA += A.values[k] * A.values[k];
+        }
+    }
+    double scale = sqrt(normA) * sqrt(normR);
+    return scale > 0.0 ? parallel_norm2(atr) / scale : 0.0;
+}
+
+static int run_least_squares(int m, int n, const vector<CoordinateEntry>& coo, bool sketch,
+                             const SketchOptions& sketchOptions) {
+    cout << "Path: least squares (" << m << " x " << n << ")" << endl;
+    CompressedSparseRowMatrix csr = coo_to_csr(m, n, coo);
+    DenseBuffer A;
+    coo_to_dense_colmaj(m, n, coo, A);
+    vector<double> b = generate_random_b(m, 1337);
+    int status = 0;
+
+    cout << "Running blocked Householder QR ..." << endl;
+    vector<double> x;
+    auto t0 = chrono::high_resolution_clock::now();
+    bool ok = solve_least_squares_qr(m, n, A.data(), b, x);
+    auto t1 = chrono::high_resolution_clock::now();
+    if (!ok) {
+        cerr << "QR least squares failed (rank deficient?)" << endl;
+        status = 1;
+    } else {
+        print_solve_report("QR", chrono::duration<double, milli>(t1 - t0).count(), compute_residual(csr, x, b));
+        cout << "QR normal-equation residual: " << normal_equation_residual(csr, x, b) << endl;
+    }
+
+    int blocks = omp_get_max_threads();
+    cout << "Running TSQR (" << max(1, min(blocks, m / max(1, 2 * n))) << " row blocks) ..." << endl;
+    t0 = chrono::high_resolution_clock::now();
+    ok = solve_least_squares_tsqr(m, n, A.data(), b, x, blocks);
+    t1 = chrono::high_resolution_clock::now();
+    if (!ok) {
+        cerr << "TSQR least squares failed (rank deficient?)" << endl;
+        status = 1;
+    } else {
+        print_solve_report("TSQR", chrono::duration<double, milli>(t1 - t0).count(), compute_residual(csr, x, b));
+        cout << "TSQR normal-equation residual: " << normal_equation_residual(csr, x, b) << endl;
+    }
+
+    if (sketch) {
+        vector<CoordinateEntry> transposed(coo);
+        for (auto& e : transposed) std::swap(e.row, e.column);
+        CompressedSparseRowMatrix csrT = coo_to_csr(n, m, transposed);
+        cout << "Running sketch-and-precondition LSQR (s = " << min(m, max(n + 1, int(sketchOptions.oversampling * n)))
+             << " sketch rows, " << sketchOptions.nonZerosPerRow << " per row of A) ..." << endl;
+        t0 = chrono::high_resolution_clock::now();
+        SketchSolveResult sketched = solve_least_squares_sketched(csr, csrT, b, x, sketchOptions);
+        t1 = chrono::high_resolution_clock::now();
+        if (!sketched.ok) {
+            cerr << "Sketched least squares failed (rank deficient sketch)" << endl;
+            status = 1;
+        } else {
+            cout << "Sketch (ms): " << sketched.sketchMs << ", sketch QR (ms): " << sketched.qrMs
+                 << ", LSQR (ms): " << sketched.lsqrMs << ", LSQR iterations: " << sketched.iterations << endl;
+            print_solve_report("Sketched LSQR", chrono::duration<double, milli>(t1 - t0).count(),
+                               compute_residual(csr, x, b));
+            cout << "Sketched LSQR normal-equation residual: " << normal_equation_residual(csr, x, b) << endl;
+            if (!sketched.converged) {
+                cerr << "Sketched LSQR did not converge in " << sketched.iterations << " iterations" << endl;
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
+
+// ============================================================================
+// Solver Selection: O(nnz) pre-analysis, condition estimates, Cholesky, mixed precision
+// ============================================================================
+
+struct MatrixAnalysis {
+    int n = 0;
+    size_t nnz = 0;
+    double density = 0.0;
+    bool symmetric = false;            // numerically, to a relative 1e-12
+    bool positiveDiagonal = false;
+    bool diagonallyDominant = false;   // strictly, by rows
+    double norm1 = 0.0;
+    double normInf = 0.0;
+    double dominanceMargin = 0.0;      // min_i |a_ii| - sum_{j != i} |a_ij|
+};
+
+/**
+ * @brief One pass over the CSR (plus a binary search per entry for the symmetry test)
+ */
+static MatrixAnalysis analyse_matrix(const CompressedSparseRowMatrix& A) {
+    MatrixAnalysis info;
+    int n = A.numberOfRows;
+    info.n = n;
+    info.nnz = A.getNumberOfNonZeros();
+    info.density = n > 0 ? double(info.nnz) / (double(n) * double(n)) : 0.0;
+
+    vector<double> columnSums(n, 0.0);
+    double normInf = 0.0, margin = numeric_limits<double>::max();
+    bool symmetric = true, positiveDiagonal = true;
+    #pragma omp parallel
+    {
+        vector<double> localColumns(n, 0.0);
+        double localNorm = 0.0, localMargin = numeric_limits<double>::max();
+        bool localSymmetric = true, localPositive = true;
+        #pragma omp for schedule(static) nowait
+        for (int i = 0; i < n; ++i) {
+            double diagonal = 0.0, offDiagonal = 0.0;
+            for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) {
+                int j = A.columnIndices[k];
+                double v = A.values[k];
+                localColumns[j] += fabs(v);
+                if (j == i) {
+                    diagonal = v;
+                } else {
+                    offDiagonal += fabs(v);
+                }
+                if (localSymmetric && j != i) {
+                    auto first = A.columnIndices.begin() + A.rowPointers[j];
+                    auto last = A.columnIndices.begin() + A.rowPointers[j + 1];
+                    auto it = lower_bound(first, last, i);
+                    double mirrored = (it != last && *it == i) ? A.values[it - A.columnIndices.begin()] : 0.0;
+                    if (fabs(mirrored - v) > 1e-12 * max(fabs(v), fabs(mirrored))) localSymmetric = false;
+                }
+            }
+            localPositive = localPositive && diagonal > 0.0;
+            localNorm = max(localNorm, fabs(diagonal) + offDiagonal);
+            localMargin = min(localMargin, fabs(diagonal) - offDiagonal);
+        }
+        #pragma omp critical
+        {
+            for (int j = 0; j < n; ++j) columnSums[j] += localColumns[j];
+            normInf = max(normInf, localNorm);
+            margin = min(margin, localMargin);
+            symmetric = symmetric && localSymmetric;
+            positiveDiagonal = positiveDiagonal && localPositive;
+        }
+    }
+    info.norm1 = n > 0 ? *max_element(columnSums.begin(), columnSums.end()) : 0.0;
+    info.normInf = normInf;
+    info.symmetric = symmetric;
+    info.positiveDiagonal = positiveDiagonal;
+    info.dominanceMargin = margin;
+    info.diagonallyDominant = margin > 0.0;
+    return info;
+}
+
+// Solve A^T x = b with the LU factors, undoing solve_dense_lu's steps in reverse
+template <typename T>
+static void solve_dense_lu_transposed(const DenseLUFactorization<T>& F, double* x) {
+    int n = F.n;
+    size_t lda = size_t(n);
+    for (int j = 0; j < n; ++j) {
+        const T* colJ = F.lu.data() + size_t(j) * lda;
+        double s = x[j];
+        for (int i = 0; i < j; ++i) s -= double(colJ[i]) * x[i];
+        x[j] = s / double(colJ[j]);
+    }
+    int lastPanel = ((n - 1) / F.blockSize) * F.blockSize;
+    for (int j0 = lastPanel; j0 >= 0; j0 -= F.blockSize) {
+        int j1 = min(n, j0 + F.blockSize);
+        for (int c = j1 - 1; c >= j0; --c) {
+            const T* colC = F.lu.data() + size_t(c) * lda;
+            double s = 0.0;
+            for (int i = c + 1; i < n; ++i) s += double(colC[i]) * x[i];
+            x[c] -= s;
+        }
+        for (int c = j1 - 1; c >= j0; --c) {
+            if (F.ipiv[c] != c) std::swap(x[c], x[F.ipiv[c]]);
+        }
+    }
+}
+
+/**
+ * @brief Hager's 1-norm power iteration with Higham's safeguard vector: estimates ||A^{-1}||_1
+ *
+ * Needs only a handful of solves with A and A^T, i.e. O(n^2) on top of the factors.
+ */
+static double estimate_inverse_norm1(int n, const function<void(double*)>& solve,
+                                     const function<void(double*)>& solveTransposed) {
+    if (n <= 0) return 0.0;
+    vector<double> x(n, 1.0 / n), y(n), z(n);
+    double estimate = 0.0;
+    for (int iteration = 0; iteration < 5; ++iteration) {
+        y = x;
+        solve(y.data());
+        double norm = 0.0;
+        for (double v : y) norm += fabs(v);
+        if (iteration > 0 && norm <= estimate) break;
+        estimate = norm;
+        for (int i = 0; i < n; ++i) z[i] = y[i] >= 0.0 ? 1.0 : -1.0;
+        solveTransposed(z.data());
+        int j = 0;
+        double zx = 0.0;
+        for (int i = 0; i < n; ++i) {
+            if (fabs(z[i]) > fabs(z[j])) j = i;
+            zx += z[i] * x[i];
+        }
+        if (iteration > 0 && fabs(z[j]) <= zx) break;
+        fill(x.begin(), x.end(), 0.0);
+        x[j] = 1.0;
+    }
+    for (int i = 0; i < n; ++i) {
+        x[i] = (i % 2 == 0 ? 1.0 : -1.0) * (1.0 + double(i) / double(max(1, n - 1)));
+    }
+    solve(x.data());
+    double alternative = 0.0;
+    for (double v : x) alternative += fabs(v);
+    return max(estimate, 2.0 * alternative / (3.0 * n));
+}
+
+/**
+ * @brief Blocked right-looking Cholesky A = L L^T (lower triangle of A only)
+ *
+ * Half the flops of LU and no pivoting; the trailing update uses the same owner tiles as
+ * the LU. Fails as soon as a diagonal entry is not positive, i.e. A is not SPD.
+ */
+struct CholeskyFactorization {
+    int n = 0;
+    int blockSize = 64;
+    DenseBuffer l;   // column-major, L on and below the diagonal
+};
+
+static bool factorize_cholesky(int n, const double* A_colmaj, CholeskyFactorization& C, int blockSize = 64) {
+    C.n = n;
+    C.blockSize = blockSize;
+    C.l.resize(size_t(n) * size_t(n));
+    double* L = C.l.data();
+    size_t lda = size_t(n);
+    #pragma omp parallel
+    for_each_owned_tile(0, n, [&](int c0, int c1) {
+        copy(A_colmaj + size_t(c0) * lda, A_colmaj + size_t(c1) * lda, L + size_t(c0) * lda);
+    });
+
+    for (int j0 = 0; j0 < n; j0 += blockSize) {
+        int j1 = min(n, j0 + blockSize);
+        for (int c = j0; c < j1; ++c) {
+            double* colC = L + size_t(c) * lda;
+            if (!(colC[c] > 0.0)) return false;
+            double d = sqrt(colC[c]);
+            colC[c] = d;
+            for (int i = c + 1; i < n; ++i) colC[i] /= d;
+            for (int t = c + 1; t < j1; ++t) {
+                double* colT = L + size_t(t) * lda;
+                double ltc = colC[t];
+                for (int i = t; i < n; ++i) colT[i] -= colC[i] * ltc;
+            }
+        }
+        int trailingTasks = (n - j1 + kTileColumns - 1) / kTileColumns;
+        #pragma omp parallel if (trailingTasks > 1)
+        for_each_owned_tile(j1, n, [&](int t0, int t1) {
+            for (int t = t0; t < t1; ++t) {
+                double* colT = L + size_t(t) * lda;
+                for (int c = j0; c < j1; ++c) {
+                    const double* colC = L + size_t(c) * lda;
+                    double ltc = colC[t];
+                    if (ltc == 0.0) continue;
+                    for (int i = t; i < n; ++i) colT[i] -= colC[i] * ltc;
+                }
+            }
+        });
+    }
+    return true;
+}
+
+// x holds b on entry
+static void solve_cholesky(const CholeskyFactorization& C, double* x) {
+    int n = C.n;
+    size_t lda = size_t(n);
+    for (int c = 0; c < n; ++c) {
+        const double* colC = C.l.data() + size_t(c) * lda;
+        x[c] /= colC[c];
+        double xc = x[c];
+        for (int i = c + 1; i < n; ++i) x[i] -= colC[i] * xc;
+    }
+    for (int c = n - 1; c >= 0; --c) {
+        const double* colC = C.l.data() + size_t(c) * lda;
+        double s = x[c];
+        for (int i = c + 1; i < n; ++i) s -= colC[i] * x[i];
+        x[c] = s / colC[c];
+    }
+}
+
+struct RefinementResult {
+    int iterations = 0;
+    bool converged = false;
+    double backwardError = 0.0;
+};
+
+/**
+ * @brief Mixed-precision iterative refinement: float LU factors, double residuals from the CSR
+ *
+ * Converges while cond(A) * eps_float stays well below 1; stops on the backward-error
+ * target or when an iteration no longer halves it.
+ */
+static RefinementResult refine_mixed_precision(const CompressedSparseRowMatrix& A, const DenseLUFactorization<float>& F,
+                                               const vector<double>& b, vector<double>& x,
+                                               double backwardTarget, int maxIterations) {
+    int n = A.numberOfRows;
+    double normB = 0.0, normA = 0.0;
+    for (double v : b) normB = max(normB, fabs(v));
+    for (int i = 0; i < n; ++i) {
+        double row = 0.0;
+        for (int k = A.rowPointers[i]; k < A.rowPointers[i + 1]; ++k) row += fabs(A.values[k]);
+        normA = max(normA, row);
+    }
+    x = b;
+    solve_dense_lu(F, x);
+    vector<double> r(n);
+    RefinementResult result;
+    double previous = numeric_limits<double>::max();
+    for (int iteration = 0; iteration <= maxIterations; ++iteration) {
+        csr_spmv(A, x.data(), r.data());
+        double normR = 0.0, normX = 0.0;
+        #pragma omp parallel for reduction(max : normR, normX) schedule(static)
+        for (int i = 0; i < n; ++i) {
+            r[i] = b[i] - r[i];
+            normR = max(normR, fabs(r[i]));
+            normX = max(normX, fabs(x[i]));
+        }
+        double scale = normA * normX + normB;
+        result.backwardError = scale > 0.0 ? normR / scale : 0.0;
+        result.iterations = iteration;
+        if (result.backwardError <= backwardTarget) {
+            result.converged = true;
+            break;
+        }
+        if (iteration == maxIterations || result.backwardError > 0.5 * previous) break;
+        previous = result.backwardError;
+        solve_dense_lu(F, r);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; ++i) x[i] += r[i];
+    }
+    return result;
+}
+
+#ifdef LAB2_WITH_MPI
+// ============================================================================
+// Distributed Dense LU: 2D block-cyclic CALU with tournament pivoting (MPI)
+// ============================================================================
+
+// Rows (or columns) among the first n that process iproc of nprocs owns (ScaLAPACK numroc)
+static int block_cyclic_count(int n, int nb, int iproc, int nprocs) {
+    int blocks = n / nb;
+    int count = (blocks / nprocs) * nb;
+    int extra = blocks % nprocs;
+    if (iproc < extra) count += nb;
+    else if (iproc == extra) count += n % nb;
+    return count;
+}
+
+// Process-grid rows for `processes` ranks: the largest divisor not above sqrt(processes)
+static int process_grid_rows(int processes) {
+    int rows = 1;
+    for (int d = 1; d * d <= processes; ++d) {
+        if (processes % d == 0) rows = d;
+    }
+    return rows;
+}
+
+// Rank owning entry (i, j) of the 2D block-cyclic map DistributedLUSolver lays out on `processes` ranks
+static int block_cyclic_owner(int i, int j, int nb, int processes) {
+    int Pr = process_grid_rows(processes), Pc = processes / Pr;
+    return ((i / nb) % Pr) * Pc + (j / nb) % Pc;
+}
+
+// Uniform(-1, 1) entry of the synthetic benchmark matrix, identical on every process grid
+static double generated_entry(int i, int j, int n) {
+    uint64_t h = mix_hash(uint64_t(i) * uint64_t(n) + uint64_t(j) + 0x5eedULL);
+    return double(h >> 11) * 0x1.0p-53 * 2.0 - 1.0;
+}
+
+/**
+ * @brief One tournament round: partial-pivoting GE on a copy of the candidate rows
+ *
+ * C is rows x w (column-major) with global row ids. On return it holds the min(rows, w)
+ * rows GEPP would pick, in pivot order, with their original (unfactorised) values.
+ * @return smallest pivot magnitude met, used to flag a singular panel
+ */
+static double tournament_select(int& rows, int w, vector<double>& C, vector<int>& ids) {
+    vector<double> work(C);
+    vector<int> order(rows);
+    iota(order.begin(), order.end(), 0);
+    int keep = min(rows, w);
+    double smallest = numeric_limits<double>::max();
+    for (int c = 0; c < keep; ++c) {
+        int piv = c;
+        double maxval = fabs(work[size_t(c) * rows + c]);
+        for (int i = c + 1; i < rows; ++i) {
+            double v = fabs(work[size_t(c) * rows + i]);
+            if (v > maxval) { maxval = v; piv = i; }
+        }
+        if (piv != c) {
+            for (int t = 0; t < w; ++t) std::swap(work[size_t(t) * rows + c], work[size_t(t) * rows + piv]);
+            std::swap(order[c], order[piv]);
+        }
+        smallest = min(smallest, maxval);
+        double p = work[size_t(c) * rows + c];
+        if (p == 0.0) continue;
+        for (int i = c + 1; i < rows; ++i) {
+            double l = work[size_t(c) * rows + i] / p;
+            for (int t = c + 1; t < w; ++t) work[size_t(t) * rows + i] -= l * work[size_t(t) * rows + c];
+        }
+    }
+    vector<double> selected(size_t(keep) * w);
+    vector<int> selectedIds(keep);
+    for (int q = 0; q < keep; ++q) {
+        selectedIds[q] = ids[order[q]];
+        for (int t = 0; t < w; ++t) selected[size_t(t) * keep + q] = C[size_t(t) * rows + order[q]];
+    }
+    C.swap(selected);
+    ids.swap(selectedIds);
+    rows = keep;
+    return smallest;
+}
+
+/**
+ * @brief Dense LU over a Pr x Pc process grid with nb x nb block-cyclic layout
+ *
+ * Per panel: tournament pivoting picks the nb pivot rows with a binary reduction over
+ * the owning process column (O(log Pr) messages instead of one per column); all swaps
+ * of the panel move in a single all-to-all per process column; the panel is then
+ * factorised without pivoting, broadcast along process rows, U12 is broadcast down
+ * process columns and every rank updates its trailing blocks with a threaded GEMM.
+ * Swaps are applied to whole rows, so the factors satisfy P A = L U.
+ */
+class DistributedLUSolver {
+public:
+    DistributedLUSolver(MPI_Comm communicator, int order, int blockSize)
+        : comm(communicator), N(order), nb(blockSize) {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        Pr = process_grid_rows(size);
+        Pc = size / Pr;
+        myRow = rank / Pc;
+        myCol = rank % Pc;
+        MPI_Comm_split(comm, myRow, myCol, &rowComm);
+        MPI_Comm_split(comm, myCol, myRow, &colComm);
+        localRows = block_cyclic_count(N, nb, myRow, Pr);
+        localCols = block_cyclic_count(N, nb, myCol, Pc);
+        local.assign(size_t(max(1, localRows)) * size_t(localCols), 0.0);
+        ipiv.assign(N, 0);
+    }
+
+    ~DistributedLUSolver() {
+        MPI_Comm_free(&rowComm);
+        MPI_Comm_free(&colComm);
+    }
+
+    int getGridRows() const { return Pr; }
+    int getGridColumns() const { return Pc; }
+
+    void fillGenerated() {
+        #pragma omp parallel for schedule(static)
+        for (int c = 0; c < localCols; ++c) {
+            int j = globalColumn(c);
+            for (int l = 0; l < localRows; ++l) at(l, c) = generated_entry(globalRow(l), j, N);
+        }
+        original = local;
+    }
+
+    void fillFromCOO(const vector<CoordinateEntry>& coo) {
+        for (const auto &e : coo) {
+            if (e.row < 0 || e.column < 0 || e.row >= N || e.column >= N) continue;
+            if (rowOwner(e.row) != myRow || columnOwner(e.column) != myCol) continue;
+            at(localRowIndex(e.row), localColumnIndex(e.column)) += e.value;
+        }
+        original = local;
+    }
+
+    bool factorize() {
+        int panels = (N + nb - 1) / nb;
+        for (int k = 0; k < panels; ++k) {
+            int K0 = k * nb, K1 = min(N, K0 + nb), w = K1 - K0;
+            int pr = k % Pr, pc = k % Pc;
+            int lr0 = block_cyclic_count(K0, nb, myRow, Pr);      // first local row >= K0
+            int lrBelow = block_cyclic_count(K1, nb, myRow, Pr);  // first local row >= K1
+            int lcK = block_cyclic_count(K0, nb, myCol, Pc);      // panel's first local column (on pc)
+            int lcBelow = block_cyclic_count(K1, nb, myCol, Pc);  // first local column >= K1
+
+            // 1. Tournament pivoting inside process column pc
+            vector<int> pivots(w);
+            int singular = 0;
+            if (myCol == pc) {
+                int rows = localRows - lr0;
+                vector<double> C(size_t(rows) * w);
+                vector<int> ids(rows);
+                for (int l = lr0; l < localRows; ++l) {
+                    ids[l - lr0] = globalRow(l);
+                    for (int t = 0; t < w; ++t) C[size_t(t) * rows + (l - lr0)] = at(l, lcK + t);
+                }
+                tournament_select(rows, w, C, ids);
+                for (int step = 1; step < Pr; step *= 2) {
+                    if (myRow % (2 * step) == step) {
+                        sendCandidates(myRow - step, rows, w, C, ids);
+                        break;
+                    }
+                    if (myRow % (2 * step) == 0 && myRow + step < Pr) {
+                        receiveAndMerge(myRow + step, rows, w, C, ids);
+                        tournament_select(rows, w, C, ids);
+                    }
+                }
+                if (myRow == 0) {
+                    double smallest = rows == w ? tournament_select(rows, w, C, ids) : 0.0;
+                    singular = smallest < 1e-15 ? 1 : 0;
+                    copy(ids.begin(), ids.end(), pivots.begin());
+                }
+            }
+            MPI_Bcast(&singular, 1, MPI_INT, pc, comm);
+            if (singular) return false;
+            MPI_Bcast(pivots.data(), w, MPI_INT, pc, comm);
+
+            // 2. Apply the panel's swaps to whole rows with one exchange per process column
+            applyPanelSwaps(K0, pivots);
+
+            // 3. Factorise the panel without pivoting: diagonal block on (pr, pc), then L21
+            vector<double> diagonal(size_t(w) * w);
+            if (myCol == pc) {
+                if (myRow == pr) {
+                    double* d = &at(lr0, lcK);
+                    for (int c = 0; c < w; ++c) {
+                        double p = d[size_t(c) * localRows + c];
+                        for (int i = c + 1; i < w; ++i) d[size_t(c) * localRows + i] /= p;
+                        for (int t = c + 1; t < w; ++t) {
+                            double u = d[size_t(t) * localRows + c];
+                            for (int i = c + 1; i < w; ++i) d[size_t(t) * localRows + i] -= d[size_t(c) * localRows + i] * u;
+                        }
+                    }
+                    for (int t = 0; t < w; ++t) {
+                        for (int i = 0; i < w; ++i) diagonal[size_t(t) * w + i] = d[size_t(t) * localRows + i];
+                    }
+                }
+                MPI_Bcast(diagonal.data(), w * w, MPI_DOUBLE, pr, colComm);
+                // L21 = A21 U11^{-1}, column by column
+                for (int c = 0; c < w; ++c) {
+                    double* colC = &at(0, lcK + c);
+                    for (int q = 0; q < c; ++q) {
+                        double u = diagonal[size_t(c) * w + q];
+                        const double* colQ = &at(0, lcK + q);
+                        for (int l = lrBelow; l < localRows; ++l) colC[l] -= colQ[l] * u;
+                    }
+                    double p = diagonal[size_t(c) * w + c];
+                    for (int l = lrBelow; l < localRows; ++l) colC[l] /= p;
+                }
+            }
+
+            // 4. Broadcast the factorised panel rows >= K0 along process rows
+            int panelRows = localRows - lr0;
+            vector<double> panel(size_t(panelRows) * w);
+            if (myCol == pc) {
+                for (int t = 0; t < w; ++t) {
+                    copy(&at(lr0, lcK + t), &at(lr0, lcK + t) + panelRows, panel.begin() + size_t(t) * panelRows);
+                }
+            }
+            if (panelRows > 0) MPI_Bcast(panel.data(), panelRows * w, MPI_DOUBLE, pc, rowComm);
+
+            // 5. U12 = L11^{-1} A12 on process row pr, broadcast down process columns
+            int trailingCols = localCols - lcBelow;
+            vector<double> U12(size_t(w) * max(0, trailingCols));
+            if (myRow == pr) {
+                #pragma omp parallel for schedule(static)
+                for (int c = lcBelow; c < localCols; ++c) {
+                    double* colT = &at(lr0, c);
+                    for (int q = 0; q < w; ++q) {
+                        double u = colT[q];
+                        for (int i = q + 1; i < w; ++i) colT[i] -= panel[size_t(q) * panelRows + i] * u;
+                    }
+                    copy(colT, colT + w, U12.begin() + size_t(c - lcBelow) * w);
+                }
+            }
+            if (trailingCols > 0) MPI_Bcast(U12.data(), w * trailingCols, MPI_DOUBLE, pr, colComm);
+
+            // 6. Local trailing update A22 -= L21 * U12
+            int offset = lrBelow - lr0;
+            int updateRows = localRows - lrBelow;
+            if (updateRows > 0 && trailingCols > 0) {
+                #pragma omp parallel for schedule(static)
+                for (int c = 0; c < trailingCols; ++c) {
+                    double* target = &at(lrBelow, lcBelow + c);
+                    for (int q = 0; q < w; ++q) {
+                        double u = U12[size_t(c) * w + q];
+                        if (u == 0.0) continue;
+                        const double* l = panel.data() + size_t(q) * panelRows + offset;
+                        for (int i = 0; i < updateRows; ++i) target[i] -= l[i] * u;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // x holds the replicated b on entry and the replicated solution on exit
+    void solve(vector<double>& x) {
+        for (int g = 0; g < N; ++g) {
+            if (ipiv[g] != g) std::swap(x[g], x[ipiv[g]]);
+        }
+        int panels = (N + nb - 1) / nb;
+        vector<double> partial(nb), reduced(nb);
+        for (int k = 0; k < panels; ++k) {
+            int K0 = k * nb, K1 = min(N, K0 + nb), w = K1 - K0;
+            int pr = k % Pr, pc = k % Pc;
+            if (myRow == pr) {
+                int lr = block_cyclic_count(K0, nb, myRow, Pr);
+                int lcEnd = block_cyclic_count(K0, nb, myCol, Pc);
+                blockRowProduct(lr, w, 0, lcEnd, x, partial);
+                MPI_Reduce(partial.data(), reduced.data(), w, MPI_DOUBLE, MPI_SUM, pc, rowComm);
+                if (myCol == pc) {
+                    int lc = block_cyclic_count(K0, nb, myCol, Pc);
+                    for (int i = 0; i < w; ++i) {
+                        double s = x[K0 + i] - reduced[i];
+                        for (int q = 0; q < i; ++q) s -= at(lr + i, lc + q) * x[K0 + q];
+                        x[K0 + i] = s;
+                    }
+                }
+            }
+            MPI_Bcast(x.data() + K0, w, MPI_DOUBLE, pr * Pc + pc, comm);
+        }
+        for (int k = panels - 1; k >= 0; --k) {
+            int K0 = k * nb, K1 = min(N, K0 + nb), w = K1 - K0;
+            int pr = k % Pr, pc = k % Pc;
+            if (myRow == pr) {
+                int lr = block_cyclic_count(K0, nb, myRow, Pr);
+                int lcBegin = block_cyclic_count(K1, nb, myCol, Pc);
+                blockRowProduct(lr, w, lcBegin, localCols, x, partial);
+                MPI_Reduce(partial.data(), reduced.data(), w, MPI_DOUBLE, MPI_SUM, pc, rowComm);
+                if (myCol == pc) {
+                    int lc = block_cyclic_count(K0, nb, myCol, Pc);
+                    for (int i = w - 1; i >= 0; --i) {
+                        double s = x[K0 + i] - reduced[i];
+                        for (int q = i + 1; q < w; ++q) s -= at(lr + i, lc + q) * x[K0 + q];
+                        x[K0 + i] = s / at(lr + i, lc + i);
+                    }
+                }
+            }
+            MPI_Bcast(x.data() + K0, w, MPI_DOUBLE, pr * Pc + pc, comm);
+        }
+    }
+
+    // Same report as compute_residual, from the kept copy of the original local blocks
+    ResidualReport residual(const vector<double>& x, const vector<double>& b) const {
+        vector<double> rowProduct(localRows, 0.0), rowAbs(localRows, 0.0);
+        for (int c = 0; c < localCols; ++c) {
+            double xj = x[globalColumn(c)];
+            const double* column = original.data() + size_t(c) * localRows;
+            for (int l = 0; l < localRows; ++l) {
+                rowProduct[l] += column[l] * xj;
+                rowAbs[l] += fabs(column[l]);
+            }
+        }
+        if (localRows > 0) {
+            MPI_Allreduce(MPI_IN_PLACE, rowProduct.data(), localRows, MPI_DOUBLE, MPI_SUM, rowComm);
+            MPI_Allreduce(MPI_IN_PLACE, rowAbs.data(), localRows, MPI_DOUBLE, MPI_SUM, rowComm);
+        }
+        double sums[1] = {0.0}, maxima[2] = {0.0, 0.0};
+        if (myCol == 0) {
+            CompensatedSum squares;
+            for (int l = 0; l < localRows; ++l) {
+                double ri = rowProduct[l] - b[globalRow(l)];
+                squares.add(ri * ri);
+                maxima[0] = max(maxima[0], fabs(ri));
+                maxima[1] = max(maxima[1], rowAbs[l]);
+            }
+            sums[0] = squares.sum - squares.compensation;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, sums, 1, MPI_DOUBLE, MPI_SUM, comm);
+        MPI_Allreduce(MPI_IN_PLACE, maxima, 2, MPI_DOUBLE, MPI_MAX, comm);
+        double normX = 0.0, normB = 0.0;
+        for (int i = 0; i < N; ++i) {
+            normX = max(normX, fabs(x[i]));
+            normB = max(normB, fabs(b[i]));
+        }
+        ResidualReport report;
+        report.norm = sqrt(max(0.0, sums[0]));
+        double scale = maxima[1] * normX + normB;
+        report.relative = scale > 0.0 ? maxima[0] / scale : 0.0;
+        return report;
+    }
+
+private:
+    MPI_Comm comm, rowComm, colComm;
+    int rank = 0, size = 1, Pr = 1, Pc = 1, myRow = 0, myCol = 0;
+    int N, nb;
+    int localRows = 0, localCols = 0;
+    vector<double> local;      // column-major, leading dimension localRows
+    vector<double> original;   // untouched copy for the residual
+    vector<int> ipiv;          // replicated: row swapped with g at global step g
+
+    double& at(int l, int c) { return local[size_t(c) * size_t(localRows) + size_t(l)]; }
+    double at(int l, int c) const { return local[size_t(c) * size_t(localRows) + size_t(l)]; }
+    int rowOwner(int g) const { return (g / nb) % Pr; }
+    int columnOwner(int g) const { return (g / nb) % Pc; }
+    int localRowIndex(int g) const { return (g / nb / Pr) * nb + g % nb; }
+    int localColumnIndex(int g) const { return (g / nb / Pc) * nb + g % nb; }
+    int globalRow(int l) const { return ((l / nb) * Pr + myRow) * nb + l % nb; }
+    int globalColumn(int c) const { return ((c / nb) * Pc + myCol) * nb + c % nb; }
+
+    void sendCandidates(int destinationRow, int rows, int w, const vector<double>& C, const vector<int>& ids) {
+        vector<int> header(size_t(w) + 1, -1);
+        header[0] = rows;
+        copy(ids.begin(), ids.end(), header.begin() + 1);
+        vector<double> values(size_t(w) * w, 0.0);
+        copy(C.begin(), C.end(), values.begin());
+        MPI_Send(header.data(), w + 1, MPI_INT, destinationRow, 10, colComm);
+        MPI_Send(values.data(), w * w, MPI_DOUBLE, destinationRow, 11, colComm);
+    }
+
+    // Stack the partner's candidates under ours (both rows x w column-major blocks)
+    void receiveAndMerge(int sourceRow, int& rows, int w, vector<double>& C, vector<int>& ids) {
+        vector<int> header(size_t(w) + 1);
+        vector<double> values(size_t(w) * w);
+        MPI_Recv(header.data(), w + 1, MPI_INT, sourceRow, 10, colComm, MPI_STATUS_IGNORE);
+        MPI_Recv(values.data(), w * w, MPI_DOUBLE, sourceRow, 11, colComm, MPI_STATUS_IGNORE);
+        int other = header[0];
+        int merged = rows + other;
+        vector<double> stacked(size_t(merged) * w);
+        for (int t = 0; t < w; ++t) {
+            copy(C.begin() + size_t(t) * rows, C.begin() + size_t(t + 1) * rows, stacked.begin() + size_t(t) * merged);
+            copy(values.begin() + size_t(t) * other, values.begin() + size_t(t + 1) * other,
+                 stacked.begin() + size_t(t) * merged + rows);
+        }
+        ids.insert(ids.end(), header.begin() + 1, header.begin() + 1 + other);
+        C.swap(stacked);
+        rows = merged;
+    }
+
+    // Record the LAPACK-style swap sequence for rows K0.. and move every displaced row once
+    void applyPanelSwaps(int K0, const vector<int>& pivots) {
+        unordered_map<int, int> where, occupant;
+        auto positionOf = [&](int g) { auto it = where.find(g); return it == where.end() ? g : it->second; };
+        auto rowAt = [&](int p) { auto it = occupant.find(p); return it == occupant.end() ? p : it->second; };
+        for (int i = 0; i < int(pivots.size()); ++i) {
+            int target = K0 + i, source = positionOf(pivots[i]);
+            ipiv[target] = source;
+            if (source == target) continue;
+            int displaced = rowAt(target), moved = rowAt(source);
+            occupant[target] = moved;
+            occupant[source] = displaced;
+            where[moved] = target;
+            where[displaced] = source;
+        }
+        vector<pair<int, int>> moves;  // (destination row, original row)
+        for (const auto& entry : occupant) {
+            if (entry.first != entry.second) moves.push_back(entry);
+        }
+        sort(moves.begin(), moves.end());
+
+        vector<int> sendCounts(Pr, 0), recvCounts(Pr, 0), sendDispl(Pr, 0), recvDispl(Pr, 0);
+        for (const auto& move : moves) {
+            if (rowOwner(move.second) == myRow) sendCounts[rowOwner(move.first)] += localCols;
+            if (rowOwner(move.first) == myRow) recvCounts[rowOwner(move.second)] += localCols;
+        }
+        for (int q = 1; q < Pr; ++q) {
+            sendDispl[q] = sendDispl[q - 1] + sendCounts[q - 1];
+            recvDispl[q] = recvDispl[q - 1] + recvCounts[q - 1];
+        }
+        vector<double> sendBuffer(size_t(sendDispl[Pr - 1] + sendCounts[Pr - 1]));
+        vector<double> recvBuffer(size_t(recvDispl[Pr - 1] + recvCounts[Pr - 1]));
+        vector<int> cursor(sendDispl);
+        for (const auto& move : moves) {
+            if (rowOwner(move.second) != myRow) continue;
+            int l = localRowIndex(move.second);
+            double* out = sendBuffer.data() + cursor[rowOwner(move.first)];
+            for (int c = 0; c < localCols; ++c) out[c] = at(l, c);
+            cursor[rowOwner(move.first)] += localCols;
+        }
+        MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispl.data(), MPI_DOUBLE,
+                      recvBuffer.data(), recvCounts.data(), recvDispl.data(), MPI_DOUBLE, colComm);
+        cursor = recvDispl;
+        for (const auto& move : moves) {
+            if (rowOwner(move.first) != myRow) continue;
+            int l = localRowIndex(move.first);
+            const double* in = recvBuffer.data() + cursor[rowOwner(move.second)];
+            for (int c = 0; c < localCols; ++c) at(l, c) = in[c];
+            cursor[rowOwner(move.second)] += localCols;
+        }
+    }
+
+    // partial[i] = sum over local columns [cBegin, cEnd) of A(lr + i, c) * x[global(c)]
+    void blockRowProduct(int lr, int w, int cBegin, int cEnd, const vector<double>& x, vector<double>& partial) const {
+        fill(partial.begin(), partial.begin() + w, 0.0);
+        for (int c = cBegin; c < cEnd; ++c) {
+            double xj = x[globalColumn(c)];
+            for (int i = 0; i < w; ++i) partial[i] += at(lr + i, c) * xj;
+        }
+    }
+};
+
+/**
+ * @brief Factorise, solve and verify on comm; prints one table row on the communicator's rank 0
+ */
+static bool run_distributed_case(MPI_Comm comm, int n, int nb, const vector<CoordinateEntry>* coo) {
+    int rank = 0, size = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    DistributedLUSolver solver(comm, n, nb);
+    if (coo != nullptr) solver.fillFromCOO(*coo); else solver.fillGenerated();
+    vector<double> b = generate_random_b(n, 1337);
+
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    bool ok = solver.factorize();
+    MPI_Barrier(comm);
+    double t1 = MPI_Wtime();
+    if (!ok) {
+        if (rank == 0) cerr << "Distributed LU failed (singular?)" << endl;
+        return false;
+    }
+    vector<double> x(b);
+    solver.solve(x);
+    MPI_Barrier(comm);
+    double t2 = MPI_Wtime();
+    ResidualReport residual = solver.residual(x, b);
+
+    if (rank == 0) {
+        double factorMs = (t1 - t0) * 1e3;
+        double gflops = (2.0 / 3.0) * double(n) * double(n) * double(n) / ((t1 - t0) * 1e9);
+        cout << setw(6) << size << setw(8) << (to_string(solver.getGridRows()) + "x" + to_string(solver.getGridColumns()))
+             << setw(8) << n << setw(14) << fixed << setprecision(2) << factorMs
+             << setw(12) << gflops << setw(12) << gflops / size
+             << setw(12) << (t2 - t1) * 1e3 << defaultfloat << setprecision(6)
+             << setw(14) << residual.norm << setw(14) << residual.relative << endl;
+    }
+    return true;
+}
+
+static void print_distributed_header() {
+    cout << setw(6) << "Ranks" << setw(8) << "Grid" << setw(8) << "N" << setw(14) << "Factor (ms)"
+         << setw(12) << "GFLOP/s" << setw(12) << "per rank" << setw(12) << "Solve (ms)"
+         << setw(14) << "Residual" << setw(14) << "Relative" << endl;
+}
+
+/**
+ * @brief --distributed entry point: one solve of the input, or a weak-scaling sweep
+ *
+ * Weak scaling keeps the per-rank matrix memory fixed (N = N0 * sqrt(p)) and runs the
+ * synthetic matrix on the first 1, 2, 4, ... ranks of MPI_COMM_WORLD in one launch.
+ */
+static int run_distributed_lu(int argc, char** argv, const string& matrixPath, int weakScalingBase, int nb) {
+    MPI_Init(&argc, &argv);
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int status = 0;
+
+    if (weakScalingBase > 0) {
+        if (rank == 0) {
+            cout << "=== CALU WEAK SCALING (N = " << weakScalingBase << " * sqrt(p), nb = " << nb << ") ===" << endl;
+            print_distributed_header();
+        }
+        vector<int> counts;
+        for (int p = 1; p < size; p *= 2) counts.push_back(p);
+        counts.push_back(size);
+        for (int p : counts) {
+            MPI_Comm sub;
+            MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &sub);
+            if (sub != MPI_COMM_NULL) {
+                int n = int(lround(weakScalingBase * sqrt(double(p))));
+                if (!run_distributed_case(sub, n, nb, nullptr)) status = 1;
+                MPI_Comm_free(&sub);
+            }
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    } else {
+        // Root reads the file; every rank keeps only the entries it owns
+        int dims[3] = {0, 0, 0};
+        vector<CoordinateEntry> coo;
+        if (rank == 0) {
+            dims[2] = MatrixMarketReader::readMatrixMarketFile(matrixPath, dims[0], dims[1], coo) ? 1 : 0;
+        }
+        MPI_Bcast(dims, 3, MPI_INT, 0, MPI_COMM_WORLD);
+        if (!dims[2] || dims[0] != dims[1]) {
+            if (rank == 0) cerr << "Distributed LU needs a readable square matrix: " << matrixPath << endl;
+            MPI_Finalize();
+            return 1;
+        }
+        // Root groups the entries by owning rank, then each rank receives only its own block
+        int n = dims[0];
+        vector<int> sendCounts(size, 0), sendDispl(size, 0);
+        vector<CoordinateEntry> grouped;
+        if (rank == 0) {
+            for (const auto& e : coo) {
+                if (e.row < 0 || e.column < 0 || e.row >= n || e.column >= n) continue;
+                ++sendCounts[block_cyclic_owner(e.row, e.column, nb, size)];
+            }
+            for (int q = 1; q < size; ++q) sendDispl[q] = sendDispl[q - 1] + sendCounts[q - 1];
+            grouped.resize(size_t(sendDispl[size - 1]) + size_t(sendCounts[size - 1]));
+            vector<int> cursor(sendDispl);
+            for (const auto& e : coo) {
+                if (e.row < 0 || e.column < 0 || e.row >= n || e.column >= n) continue;
+                grouped[cursor[block_cyclic_owner(e.row, e.column, nb, size)]++] = e;
+            }
+            vector<CoordinateEntry>().swap(coo);
+        }
+        int localCount = 0;
+        MPI_Scatter(sendCounts.data(), 1, MPI_INT, &localCount, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        coo.resize(size_t(localCount));
+        MPI_Datatype entryType;
+        MPI_Type_contiguous(int(sizeof(CoordinateEntry)), MPI_BYTE, &entryType);
+        MPI_Type_commit(&entryType);
+        MPI_Scatterv(grouped.data(), sendCounts.data(), sendDispl.data(), entryType,
+                     coo.data(), localCount, entryType, 0, MPI_COMM_WORLD);
+        MPI_Type_free(&entryType);
+        vector<CoordinateEntry>().swap(grouped);
+        if (rank == 0) {
+            cout << "=== DISTRIBUTED CALU (" << matrixPath << ", nb = " << nb << ") ===" << endl;
+            print_distributed_header();
+        }
+        if (!run_distributed_case(MPI_COMM_WORLD, n, nb, &coo)) status = 1;
+    }
+
+    MPI_Finalize();
+    return status;
+}
+#endif
+
+// ============================================================================
+// Hardware Performance Counters: perf_event_open around solver phases
+// ============================================================================
+
+/**
+ * @brief Per-phase cycles, instructions, L1D and LLC read misses over all OpenMP threads
+ *
+ * One counter group is opened per OpenMP worker (counters follow the thread, and the
+ * runtime keeps its workers across parallel regions), user space only. When the kernel
+ * refuses (no PMU in a VM, perf_event_paranoid, seccomp) the profiler still reports
+ * time and GFLOP/s; single events the CPU lacks show as n/a.
+ */
+class PhaseProfiler {
+public:
+    static constexpr int kEvents = 4;
+
+    PhaseProfiler() = default;
+    PhaseProfiler(const PhaseProfiler&) = delete;
+    PhaseProfiler& operator=(const PhaseProfiler&) = delete;
+    ~PhaseProfiler() {
+        for (auto& group : fds) {
+            for (int fd : group) {
+                if (fd >= 0) ::close(fd);
+            }
+        }
+    }
+
+    bool open() {
+        static const pair<uint32_t, uint64_t> events[kEvents] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        };
+        int threads = omp_get_max_threads();
+        fds.assign(threads, {});
+        for (auto& group : fds) group.fill(-1);
+        int openErrno = 0;
+        #pragma omp parallel num_threads(threads)
+        {
+            auto& group = fds[omp_get_thread_num()];
+            for (int e = 0; e < kEvents; ++e) {
+                group[e] = open_event(events[e].first, events[e].second, e == 0 ? -1 : group[0]);
+                if (e == 0 && group[0] < 0) {
+                    #pragma omp critical
+                    openErrno = errno;
+                    break;
+                }
+            }
+        }
+        available = true;
+        for (const auto& group : fds) available = available && group[0] >= 0;
+        if (!available) {
+            unavailableReason = string("perf_event_open: ") + strerror(openErrno);
+            return false;
+        }
+        return true;
+    }
+
+    bool isAvailable() const { return available; }
+    const string& getUnavailableReason() const { return unavailableReason; }
+
+    // Time and count one phase; flops feed the GFLOP/s column
+    template <typename Body>
+    void measure(const string& name, double flops, Body&& body) {
+        for (const auto& group : fds) {
+            if (group[0] < 0) continue;
+            ioctl(group[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(group[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        auto t0 = chrono::high_resolution_clock::now();
+        body();
+        auto t1 = chrono::high_resolution_clock::now();
+        Phase phase;
+        phase.name = name;
+        phase.ms = chrono::duration<double, milli>(t1 - t0).count();
+        phase.flops = flops;
+        phase.valid.fill(available);
+        phase.counts.fill(0.0);
+        for (const auto& group : fds) {
+            if (group[0] < 0) continue;
+            ioctl(group[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            for (int e = 0; e < kEvents; ++e) {
+                double value = 0.0;
+                if (!read_scaled(group[e], value)) phase.valid[e] = false;
+                phase.counts[e] += value;
+            }
+        }
+        phases.push_back(phase);
+    }
+
+    void print() const {
+        cout << "=== CPU PHASE COUNTERS (" << fds.size() << " threads";
+        if (!available) cout << "; counters unavailable, " << unavailableReason;
+        cout << ") ===" << endl;
+        cout << left << setw(18) << "Phase" << right << setw(12) << "Time (ms)" << setw(10) << "GFLOP/s"
+             << setw(16) << "Cycles" << setw(16) << "Instructions" << setw(7) << "IPC"
+             << setw(14) << "L1D misses" << setw(14) << "LLC misses" << endl;
+        for (const auto& phase : phases) {
+            double gflops = phase.ms > 0.0 ? phase.flops / (phase.ms * 1e6) : 0.0;
+            cout << left << setw(18) << phase.name << right << fixed << setprecision(3) << setw(12) << phase.ms
+                 << setw(10) << gflops << setprecision(0);
+            for (int e : {0, 1}) print_count(phase, e, 16);
+            if (phase.valid[0] && phase.valid[1] && phase.counts[0] > 0.0) {
+                cout << setw(7) << setprecision(2) << phase.counts[1] / phase.counts[0] << setprecision(0);
+            } else {
+                cout << setw(7) << "n/a";
+            }
+            for (int e : {2, 3}) print_count(phase, e, 14);
+            cout << defaultfloat << setprecision(6) << endl;
+        }
+    }
+
+private:
+    struct Phase {
+        string name;
+        double ms = 0.0;
+        double flops = 0.0;
+        array<double, kEvents> counts{};
+        array<bool, kEvents> valid{};
+    };
+
+    vector<array<int, kEvents>> fds;
+    vector<Phase> phases;
+    bool available = false;
+    string unavailableReason;
+
+    static int open_event(uint32_t type, uint64_t config, int groupFd) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = groupFd < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+
+    // Count extrapolated over the time the event was actually scheduled (multiplexing)
+    static bool read_scaled(int fd, double& value) {
+        if (fd < 0) return false;
+        uint64_t data[3] = {0, 0, 0};
+        if (::read(fd, data, sizeof(data)) != ssize_t(sizeof(data))) return false;
+        if (data[2] == 0) {
+            value = 0.0;
+            return data[0] == 0;
+        }
+        value = double(data[0]) * double(data[1]) / double(data[2]);
+        return true;
+    }
+
+    static void print_count(const Phase& phase, int e, int width) {
+        if (phase.valid[e]) cout << setw(width) << phase.counts[e];
+        else cout << setw(width) << "n/a";
+    }
+};
+
+// ============================================================================
+// Command Line Options
+// ============================================================================
+
+struct SolverOptions {
+    string matrixPath;
+    int repeat = 5;
+    string method = "dense";        // dense | gmres | bicgstab | auto
+    double targetAccuracy = 1e-8;   // auto: relative forward error to reach
+    string preconditioner = "ilu0"; // none | ilu0 | ilut
+    bool allowBandPath = true;
+    int updateEntries = 0;          // > 0: run the low-rank update demo on the dense path
+    int updateRounds = 5;
+    bool hodlr = false;             // also compress/solve in HODLR form and compare with dense LU
+    int hodlrLeaf = 128;
+    double hodlrTolerance = 1e-8;
+    bool sketch = false;            // least squares: also run sketch-and-precondition LSQR
+    SketchOptions sketchOptions;
+    bool distributed = false;       // MPI CALU (lab2_mpi build only)
+    int weakScalingBase = 0;        // > 0: synthetic weak-scaling sweep with N = base * sqrt(p)
+    int distributedBlock = 64;
+    int smallBenchSystems = 0;      // > 0: latency benchmark of the n <= 16 kernels, no input needed
+    bool perf = false;              // hardware counters per CPU phase
+    bool numaBench = false;         // compare first-touch / page placements of the CPU factor
+    PageMode pages = PageMode::Default;
+    string batchPath;               // directory or manifest: solve every system in it
+    string writeBinaryPath;         // convert the input to the binary dense format and exit
+    int ilutFill = 20;
+    double ilutDrop = 1e-4;
+    KrylovOptions krylov;
+};
+
+static void print_usage(const char* programName) {
+    cout << "Usage: " << programName << " <matrix.mtx | matrix.bin> [--repeat N]" << endl;
+    cout << "  --method dense|gmres|bicgstab|auto  solver path (default: dense); auto analyses A and picks" << endl;
+    cout << "  --target-accuracy E             auto: relative forward-error target (default: 1e-8)" << endl;
+    cout << "  --precond none|ilu0|ilut        Krylov preconditioner (default: ilu0)" << endl;
+    cout << "  --write-binary OUT              write the input as a binary dense file (mappable input) and exit" << endl;
+    cout << "  --update-entries K [--update-rounds R]  re-solve after R rounds of K changed entries (Woodbury)" << endl;
+    cout << "  --hodlr [--hodlr-leaf L] [--hodlr-tol T]  HODLR compressed solve vs dense LU (default: 128, 1e-8)" << endl;
+    cout << "  --sketch [--sketch-factor G] [--sketch-nnz Z]  least squares: sketched LSQR (default: 4, 8)" << endl;
+    cout << "  --small-bench [COUNT]           per-solve latency of the unrolled n <= 16 kernels vs generic LU" << endl;
+    cout << "  --pages 4k|thp|2mb              backing pages of the CPU factor (2mb needs vm.nr_hugepages, else THP)" << endl;
+    cout << "  --numa-bench                    first-touch/page placement comparison: touch and sweep GB/s, GFLOP/s" << endl;
+    cout << "  --perf                          cycles/IPC/L1D/LLC misses and GFLOP/s per CPU phase (perf_event_open)" << endl;
+    cout << "  --batch DIR|MANIFEST            solve every .mtx/.bin system, loading the next one in the background" << endl;
+    cout << "  --distributed [--dist-block NB]  MPI CALU on a 2D block-cyclic grid (lab2_mpi, run under mpirun)" << endl;
+    cout << "  --weak-scaling N0               with --distributed: synthetic sweep over 1, 2, 4, ... ranks, N = N0*sqrt(p)" << endl;
+    cout << "  --no-band                       never switch the dense path to band storage" << endl;
+    cout << "  --restart M                     GMRES restart length (default: 50)" << endl;
+    cout << "  --tol T                         Krylov relative residual target (default: 1e-10)" << endl;
+    cout << "  --maxit K                       Krylov iteration limit (default: 1000)" << endl;
+    cout << "  --ilut-fill P --ilut-drop TAU   ILUT fill per row and drop tolerance (default: 20, 1e-4)" << endl;
+}
+
+static bool parse_options(int argc, char** argv, SolverOptions& opts) {
+    if (argc < 2) return false;
+    int first = 1;
+    if (string(argv[1]).rfind("--", 0) != 0) opts.matrixPath = argv[first++];
+    for (int i = first; i < argc; ++i) {
+        string s = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (s == "--repeat" && hasValue) { opts.repeat = atoi(argv[++i]); }
+        else if (s == "--method" && hasValue) { opts.method = argv[++i]; }
+        else if (s == "--target-accuracy" && hasValue) { opts.targetAccuracy = atof(argv[++i]); }
+        else if (s == "--precond" && hasValue) { opts.preconditioner = argv[++i]; }
+        else if (s == "--write-binary" && hasValue) { opts.writeBinaryPath = argv[++i]; }
+        else if (s == "--update-entries" && hasValue) { opts.updateEntries = atoi(argv[++i]); }
+        else if (s == "--update-rounds" && hasValue) { opts.updateRounds = atoi(argv[++i]); }
+        else if (s == "--hodlr") { opts.hodlr = true; }
+        else if (s == "--hodlr-leaf" && hasValue) { opts.hodlrLeaf = atoi(argv[++i]); }
+        else if (s == "--hodlr-tol" && hasValue) { opts.hodlrTolerance = atof(argv[++i]); }
+        else if (s == "--sketch") { opts.sketch = true; }
+        else if (s == "--sketch-factor" && hasValue) { opts.sketchOptions.oversampling = atof(argv[++i]); }
+        else if (s == "--sketch-nnz" && hasValue) { opts.sketchOptions.nonZerosPerRow = atoi(argv[++i]); }
+        else if (s == "--small-bench") {
+            opts.smallBenchSystems = 20000;
+            if (hasValue && isdigit((unsigned char)argv[i + 1][0])) opts.smallBenchSystems = atoi(argv[++i]);
+        }
+        else if (s == "--perf") { opts.perf = true; }
+        else if (s == "--numa-bench") { opts.numaBench = true; }
+        else if (s == "--pages" && hasValue) {
+            string mode = argv[++i];
+            if (mode == "4k") opts.pages = PageMode::Default;
+            else if (mode == "thp") opts.pages = PageMode::TransparentHuge;
+            else if (mode == "2mb") opts.pages = PageMode::ExplicitHuge;
+            else {
+                cerr << "Unknown page mode: " << mode << endl;
+                return false;
+            }
+        }
+        else if (s == "--batch" && hasValue) { opts.batchPath = argv[++i]; }
+        else if (s == "--distributed") { opts.distributed = true; }
+        else if (s == "--weak-scaling" && hasValue) { opts.weakScalingBase = atoi(argv[++i]); }
+        else if (s == "--dist-block" && hasValue) { opts.distributedBlock = atoi(argv[++i]); }
+        else if (s == "--no-band") { opts.allowBandPath = false; }
+        else if (s == "--restart" && hasValue) { opts.krylov.restart = atoi(argv[++i]); }
+        else if (s == "--tol" && hasValue) { opts.krylov.tolerance = atof(argv[++i]); }
+        else if (s == "--maxit" && hasValue) { opts.krylov.maxIterations = atoi(argv[++i]); }
+        else if (s == "--ilut-fill" && hasValue) { opts.ilutFill = atoi(argv[++i]); }
+        else if (s == "--ilut-drop" && hasValue) { opts.ilutDrop = atof(argv[++i]); }
+        else {
+            cerr << "Unknown or incomplete option: " << s << endl;
+            return false;
+        }
+    }
+    if (opts.method != "dense" && opts.method != "gmres" && opts.method != "bicgstab" && opts.method != "auto") {
+        cerr << "Unknown method: " << opts.method << endl;
+        return false;
+    }
+    if (opts.preconditioner != "none" && opts.preconditioner != "ilu0" && opts.preconditioner != "ilut") {
+        cerr << "Unknown preconditioner: " << opts.preconditioner << endl;
+        return false;
+    }
+    if (opts.matrixPath.empty() && opts.batchPath.empty() && opts.smallBenchSystems <= 0 && !(opts.distributed && opts.weakScalingBase > 0)) return false;
+    if (opts.distributedBlock < 1) {
+        cerr << "--dist-block must be positive" << endl;
+        return false;
+    }
+    if (opts.hodlrLeaf < 1) {
+        cerr << "--hodlr-leaf must be positive" << endl;
+        return false;
+    }
+    // Below ~1e-14 the compression stopping test is beneath round-off and can never pass
+    if (!(opts.hodlrTolerance >= 1e-14)) {
+        cerr << "--hodlr-tol must be at least 1e-14" << endl;
+        return false;
+    }
+    // The profiler wraps the dense LU phases only; Krylov and auto runs have none to count
+    if (opts.perf && opts.method != "dense") {
+        cerr << "--perf counts the dense LU phases and cannot be combined with --method " << opts.method << endl;
+        return false;
+    }
+    if (opts.perf && (opts.smallBenchSystems > 0 || !opts.batchPath.empty() || opts.distributed)) {
+        cerr << "--perf counts the single-matrix dense LU phases and cannot be combined with --small-bench, --batch or --distributed" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Sparse iterative path: works on CSR only, never densifies A
+static int run_krylov_solver(const SolverOptions& opts, int n, const vector<CoordinateEntry>& coo) {
+    CompressedSparseRowMatrix csr = coo_to_csr(n, n, coo);
+    vector<double> b = generate_random_b(n, 1337);
+    cout << "CSR: n=" << n << ", nnz=" << csr.getNumberOfNonZeros()
+         << ", threads=" << omp_get_max_threads() << endl;
+
+    unique_ptr<IncompleteLUPreconditioner> M;
+    if (opts.preconditioner != "none") {
+        auto t0 = chrono::high_resolution_clock::now();
+        M = make_unique<IncompleteLUPreconditioner>(
+            opts.preconditioner == "ilu0"
+                ? IncompleteLUPreconditioner::buildILU0(csr)
+                : IncompleteLUPreconditioner::buildILUT(csr, opts.ilutFill, opts.ilutDrop));
+        auto t1 = chrono::high_resolution_clock::now();
+        cout << "Preconditioner " << opts.preconditioner << " setup (ms): "
+             << chrono::duration<double, milli>(t1 - t0).count()
+             << ", factor nnz: " << M->getNumberOfNonZeros() << endl;
+    }
+
+    string label = opts.method == "gmres" ? "GMRES(" + to_string(opts.krylov.restart) + ")" : "BiCGStab";
+    cout << "Running " << label << " solver ..." << endl;
+    vector<double> x;
+    auto t0 = chrono::high_resolution_clock::now();
+    KrylovResult result = opts.method == "gmres"
+        ? solve_gmres(csr, M.get(), b, x, opts.krylov)
+        : solve_bicgstab(csr, M.get(), b, x, opts.krylov);
+    auto t1 = chrono::high_resolution_clock::now();
+    double ms = chrono::duration<double, milli>(t1 - t0).count();
+
+    if (!result.converged) {
+        cerr << label << " did not converge in " << result.iterations << " iterations (relative residual "
+             << result.relativeResidual << ")" << endl;
+    }
+    print_solve_report(label, ms, compute_residual(csr, x, b));
+    cout << label << " iterations: " << result.iterations << endl;
+    return result.converged ? 0 : 1;
+}
+
+/**
+ * @brief --method auto: pick the cheapest solver expected to meet --target-accuracy
+ *
+ * The target is a relative forward error, estimated as cond_1(A) times the achieved
+ * backward error. Order of preference: band LU when the band is narrow; BiCGStab + ILU(0)
+ * for large sparse diagonally dominant systems (Varah's bound gives cond in O(nnz));
+ * Cholesky for SPD candidates; float LU + refinement when cond * eps_float is small;
+ * double LU otherwise. Every fallback is reported.
+ */
+static int run_auto_solver(const SolverOptions& opts, int n, const vector<CoordinateEntry>& coo) {
+    const double eps = numeric_limits<double>::epsilon();
+    const double epsSingle = double(numeric_limits<float>::epsilon());
+    const int mixedPrecisionMinSize = 256;
+    double target = opts.targetAccuracy;
+
+    auto tAnalysis0 = chrono::high_resolution_clock::now();
+    CompressedSparseRowMatrix csr = coo_to_csr(n, n, coo);
+    MatrixAnalysis info = analyse_matrix(csr);
+    Bandwidth bw = detect_bandwidth(coo);
+    auto tAnalysis1 = chrono::high_resolution_clock::now();
+    cout << "Analysis (ms): " << chrono::duration<double, milli>(tAnalysis1 - tAnalysis0).count()
+         << ", n=" << n << ", nnz=" << info.nnz << ", density=" << info.density
+         << ", symmetric=" << (info.symmetric ? "yes" : "no")
+         << ", diagonally dominant=" << (info.diagonallyDominant ? "yes" : "no")
+         << ", ||A||_1=" << info.norm1 << ", bandwidth kl=" << bw.lower << " ku=" << bw.upper << endl;
+
+    vector<double> b = generate_random_b(n, 1337);
+    vector<double> x;
+    auto finish = [&](const string& label, double ms, double condition) {
+        ResidualReport residual = compute_residual(csr, x, b);
+        print_solve_report(label, ms, residual);
+        cout << "Condition estimate: " << condition << ", estimated forward error: "
+             << condition * residual.relative << " (target " << target << ")" << endl;
+        if (condition * eps >= 1.0) {
+            cout << "Warning: matrix is numerically singular in double precision" << endl;
+        } else if (condition * eps > target) {
+            cout << "Warning: target not reachable in double precision (cond * eps = " << condition * eps << ")" << endl;
+        }
+        return 0;
+    };
+
+    if (opts.allowBandPath && band_path_pays_off(n, bw)) {
+        cout << "Auto choice: band LU (narrow band)" << endl;
+        return run_banded_solver(n, coo, bw);
+    }
+
+    if (info.diagonallyDominant && n >= 1000 && info.density <= 0.05) {
+        // Varah: ||A^{-1}||_inf <= 1 / min_i (|a_ii| - sum_{j != i} |a_ij|)
+        double condition = info.normInf / info.dominanceMargin;
+        KrylovOptions krylov = opts.krylov;
+        krylov.tolerance = clamp(target / condition, 10.0 * eps, 1e-2);
+        cout << "Auto choice: BiCGStab + ILU(0) (sparse, diagonally dominant, cond_inf <= " << condition
+             << ", tolerance " << krylov.tolerance << ")" << endl;
+        auto t0 = chrono::high_resolution_clock::now();
+        IncompleteLUPreconditioner M = IncompleteLUPreconditioner::buildILU0(csr);
+        KrylovResult result = solve_bicgstab(csr, &M, b, x, krylov);
+        auto t1 = chrono::high_resolution_clock::now();
+        if (result.converged) {
+            cout << "BiCGStab iterations: " << result.iterations << endl;
+            return finish("Auto BiCGStab", chrono::duration<double, milli>(t1 - t0).count(), condition);
+        }
+        cout << "BiCGStab did not converge in " << result.iterations << " iterations, falling back to a direct solver" << endl;
+    }
+
+    DenseBuffer A;
+    coo_to_dense_colmaj(n, n, coo, A);
+    DensePlacement placement;
+    placement.pages = opts.pages;
+
+    if (info.symmetric && info.positiveDiagonal) {
+        CholeskyFactorization C;
+        auto t0 = chrono::high_resolution_clock::now();
+        bool ok = factorize_cholesky(n, A.data(), C);
+        if (ok) {
+            x = b;
+            solve_cholesky(C, x.data());
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        if (ok) {
+            auto solve = [&](double* v) { solve_cholesky(C, v); };
+            double condition = info.norm1 * estimate_inverse_norm1(n, solve, solve);
+            cout << "Auto choice: Cholesky (symmetric positive definite)" << endl;
+            return finish("Auto Cholesky", chrono::duration<double, milli>(t1 - t0).count(), condition);
+        }
+        cout << "Cholesky failed (not positive definite), using LU" << endl;
+    }
+
+    if (n >= mixedPrecisionMinSize) {
+        DenseLUFactorization<float> Fs;
+        Fs.placement = placement;
+        auto t0 = chrono::high_resolution_clock::now();
+        bool ok = factorize_dense_lu(n, A.data(), Fs);
+        auto t1 = chrono::high_resolution_clock::now();
+        if (ok) {
+            double condition = info.norm1 * estimate_inverse_norm1(n,
+                [&](double* v) { solve_dense_lu(Fs, v); },
+                [&](double* v) { solve_dense_lu_transposed(Fs, v); });
+            auto t2 = chrono::high_resolution_clock::now();
+            cout << "Float LU (ms): " << chrono::duration<double, milli>(t1 - t0).count()
+                 << ", condition estimate (ms): " << chrono::duration<double, milli>(t2 - t1).count() << endl;
+            if (condition * epsSingle < 0.1 && condition * eps <= target) {
+                double backwardTarget = max(target / condition, 2.0 * eps);
+                auto r0 = chrono::high_resolution_clock::now();
+                RefinementResult refined = refine_mixed_precision(csr, Fs, b, x, backwardTarget, 10);
+                auto r1 = chrono::high_resolution_clock::now();
+                if (refined.converged) {
+                    cout << "Auto choice: mixed-precision LU (float factors, " << refined.iterations
+                         << " refinement steps)" << endl;
+                    double ms = chrono::duration<double, milli>((t1 - t0) + (r1 - r0)).count();
+                    return finish("Auto mixed-precision LU", ms, condition);
+                }
+                cout << "Refinement stalled at backward error " << refined.backwardError << ", using double LU" << endl;
+            } else {
+                cout << "cond * eps_float = " << condition * epsSingle << ": too ill-conditioned for float factors" << endl;
+            }
+        }
+    }
+
+    DenseLUFactorization<double> F;
+    F.placement = placement;
+    auto t0 = chrono::high_resolution_clock::now();
+    bool ok = factorize_dense_lu(n, A.data(), F);
+    if (ok) {
+        x = b;
+        solve_dense_lu(F, x);
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    if (!ok) {
+        cerr << "LU failed: a pivot fell below 1e-15 (singular matrix)" << endl;
+        return 1;
+    }
+    double condition = info.norm1 * estimate_inverse_norm1(n,
+        [&](double* v) { solve_dense_lu(F, v); },
+        [&](double* v) { solve_dense_lu_transposed(F, v); });
+    cout << "Auto choice: LU (double)" << endl;
+    return finish("Auto LU", chrono::duration<double, milli>(t1 - t0).count(), condition);
+}
+
+static int count_numa_nodes() {
+    int nodes = 0;
+    error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        string name = entry.path().filename().string();
+        if (name.rfind("node", 0) == 0 && name.size() > 4 && isdigit((unsigned char)name[4])) ++nodes;
+    }
+    return max(nodes, 1);
+}
+
+/**
+ * @brief Same factorisation under each placement: first-touch copy, owner-pattern sweep, LU
+ *
+ * The sweep reads every column by its tile owner, i.e. the access pattern of the trailing
+ * updates, so it shows remote-memory traffic when pages and owners disagree.
+ */
+static void run_placement_comparison(int n, const double* A,
+                                     const function<ResidualReport(const vector<double>&, const vector<double>&)>& verify) {
+    struct Config { const char* name; DensePlacement placement; };
+    const Config configs[] = {
+        {"serial", {FirstTouch::Serial, PageMode::Default}},
+        {"static", {FirstTouch::StaticColumns, PageMode::Default}},
+        {"owner", {FirstTouch::OwnerTiles, PageMode::Default}},
+        {"owner", {FirstTouch::OwnerTiles, PageMode::TransparentHuge}},
+        {"owner", {FirstTouch::OwnerTiles, PageMode::ExplicitHuge}},
+    };
+    cout << "=== DENSE PLACEMENT (n=" << n << ", " << omp_get_max_threads() << " threads, "
+         << count_numa_nodes() << " NUMA nodes) ===" << endl;
+    if (omp_get_proc_bind() == omp_proc_bind_false) {
+        cout << "Note: threads are not bound; set OMP_PROC_BIND=true OMP_PLACES=cores for stable first touch" << endl;
+    }
+    cout << left << setw(9) << "Touch" << setw(7) << "Pages" << right << setw(12) << "Touch (ms)"
+         << setw(12) << "Touch GB/s" << setw(12) << "Sweep GB/s" << setw(13) << "Factor (ms)"
+         << setw(10) << "GFLOP/s" << setw(14) << "Relative" << endl;
+
+    vector<double> b = generate_random_b(n, 1337);
+    double bytes = double(n) * double(n) * sizeof(double);
+    double nd = double(n);
+    for (const auto& config : configs) {
+        explicitHugePagesFellBack = false;
+        DenseLUFactorization<double> F;
+        F.placement = config.placement;
+        auto t0 = chrono::high_resolution_clock::now();
+        place_dense_factor(n, A, F);
+        auto t1 = chrono::high_resolution_clock::now();
+
+        double bestSweep = numeric_limits<double>::max();
+        double checksum = 0.0;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto s0 = chrono::high_resolution_clock::now();
+            #pragma omp parallel reduction(+ : checksum)
+            for_each_owned_tile(0, n, [&](int c0, int c1) {
+                const double* column = F.lu.data() + size_t(c0) * size_t(n);
+                const double* end = F.lu.data() + size_t(c1) * size_t(n);
+                double sum = 0.0;
+                #pragma omp simd reduction(+ : sum)
+                for (const double* p = column; p < end; ++p) sum += *p;
+                checksum += sum;
+            });
+            auto s1 = chrono::high_resolution_clock::now();
+            bestSweep = min(bestSweep, chrono::duration<double>(s1 - s0).count());
+        }
+
+        F.blockSize = 64;
+        F.ipiv.assign(n, 0);
+        auto f0 = chrono::high_resolution_clock::now();
+        bool ok = lu_factorize_blocked(n, F.lu.data(), n, F.ipiv.data(), F.blockSize,
+                                       config.placement.touch == FirstTouch::OwnerTiles);
+        auto f1 = chrono::high_resolution_clock::now();
+        double touchSeconds = chrono::duration<double>(t1 - t0).count();
+        double factorMs = chrono::duration<double, milli>(f1 - f0).count();
+
+        string pages = page_mode_name(config.placement.pages);
+        if (explicitHugePagesFellBack) pages = "thp*";
+        cout << left << setw(9) << config.name << setw(7) << pages << right << fixed << setprecision(2)
+             << setw(12) << touchSeconds * 1e3 << setw(12) << 2.0 * bytes / touchSeconds / 1e9
+             << setw(12) << bytes / bestSweep / 1e9 << setw(13) << factorMs
+             << setw(10) << (2.0 / 3.0) * nd * nd * nd / (factorMs * 1e6) << defaultfloat << setprecision(6);
+        if (ok) {
+            vector<double> x(b);
+            solve_dense_lu(F, x);
+            cout << setw(14) << verify(x, b).relative << endl;
+        } else {
+            cout << setw(14) << "singular" << endl;
+        }
+        if (!isfinite(checksum)) cout << "(non-finite entries in A)" << endl;
+    }
+    if (explicitHugePagesFellBack) {
+        cout << "thp*: no reserved 2MB pages (vm.nr_hugepages), transparent huge pages used instead" << endl;
+    }
+}
+
+// Dense path: CPU blocked LU and GPU cuSOLVER on the same column-major A.
+// With a profiler the CPU solve is split into counted phases; verifyFlops sizes the residual phase.
+static int run_dense_solvers(const SolverOptions& opts, int n, const double* A,
+                             const function<ResidualReport(const vector<double>&, const vector<double>&)>& verify,
+                             PhaseProfiler* profiler = nullptr, double verifyFlops = 0.0) {
+    // Generate random b
+    vector<double> b = generate_random_b(n, 1337);
+
+    // CPU solve
+    vector<double> x_cpu;
+
+    cout << "Running CPU solver (blocked LU, lazy pivoting) ..." << endl;
+    auto t0 = chrono::high_resolution_clock::now();
+    bool ok_cpu = false;
+    DensePlacement placement;
+    placement.pages = opts.pages;
+    if (profiler != nullptr) {
+        DenseLUFactorization<double> F;
+        F.placement = placement;
+        double nd = double(n);
+        profiler->measure("factorisation", 2.0 / 3.0 * nd * nd * nd, [&] { ok_cpu = factorize_dense_lu(n, A, F); });
+        if (ok_cpu) {
+            x_cpu = b;
+            profiler->measure("triangular solve", 2.0 * nd * nd, [&] { solve_dense_lu(F, x_cpu); });
+        }
+    } else {
+        ok_cpu = solve_dense_cpu_gauss(n, A, b, x_cpu, placement);
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    double cpu_ms = chrono::duration<double, milli>(t1 - t0).count();
+    if (!ok_cpu) {
+        cerr << "CPU solver failed (singular?)" << endl;
+    } else if (profiler != nullptr) {
+        ResidualReport residual;
+        profiler->measure("residual", verifyFlops, [&] { residual = verify(x_cpu, b); });
+        print_solve_report("CPU", cpu_ms, residual);
+    } else {
+        print_solve_report("CPU", cpu_ms, verify(x_cpu, b));
+    }
+    if (profiler != nullptr) profiler->print();
+
+    // GPU solve
+    vector<double> x_gpu(n, 0.0);
+    float gpu_ms = 0.0f;
+    cout << "Running GPU solver (cuSOLVER) ..." << endl;
+    bool ok_gpu = solve_dense_gpu(n, A, b.data(), x_gpu.data(), 1, &gpu_ms);
+    if (!ok_gpu) {
+        cerr << "GPU solver returned failure" << endl;
+    } else {
+        print_solve_report("GPU", gpu_ms, verify(x_gpu, b));
+    }
+
+    if (opts.numaBench) {
+        run_placement_comparison(n, A, verify);
+    }
+    if (opts.hodlr) {
+        run_hodlr_comparison(n, A, opts.hodlrLeaf, opts.hodlrTolerance, verify);
+    }
+    if (opts.updateEntries > 0) {
+        run_low_rank_update_demo(n, A, opts.updateEntries, opts.updateRounds);
+    }
+    return 0;
+}
+
+/**
+ * @brief Latency per solve for n = 1..16: unrolled fixed-size kernels vs the generic blocked LU
+ */
+static int run_small_system_benchmark(int systems) {
+    cout << "=== SMALL SYSTEMS (" << systems << " random systems per n) ===" << endl;
+    cout << setw(4) << "n" << setw(14) << "Generic (ns)" << setw(12) << "Fixed (ns)" << setw(10) << "Speedup"
+         << setw(14) << "Max rel diff" << endl;
+    mt19937_64 rng(2024);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    int failures = 0;
+    for (int n = 1; n <= kMaxFixedSize; ++n) {
+        size_t nn = size_t(n) * size_t(n);
+        vector<double> As(size_t(systems) * nn), bs(size_t(systems) * n);
+        for (auto& v : As) v = dist(rng);
+        for (auto& v : bs) v = dist(rng);
+        vector<double> xGeneric(bs.size()), xFixed(bs.size());
+
+        DenseLUFactorization<double> F;
+        vector<double> x(n);
+        auto t0 = chrono::high_resolution_clock::now();
+        for (int s = 0; s < systems; ++s) {
+            if (!factorize_dense_lu(n, As.data() + s * nn, F)) ++failures;
+            copy(bs.begin() + size_t(s) * n, bs.begin() + size_t(s + 1) * n, x.begin());
+            solve_dense_lu(F, x);
+            copy(x.begin(), x.end(), xGeneric.begin() + size_t(s) * n);
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        FixedSizeSolver solver = kFixedSizeSolvers[n - 1];
+        for (int s = 0; s < systems; ++s) {
+            if (!solver(As.data() + s * nn, bs.data() + size_t(s) * n, xFixed.data() + size_t(s) * n)) ++failures;
+        }
+        auto t2 = chrono::high_resolution_clock::now();
+
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < xFixed.size(); ++i) {
+            maxDiff = max(maxDiff, fabs(xFixed[i] - xGeneric[i]) / max(1.0, fabs(xGeneric[i])));
+        }
+        double genericNs = chrono::duration<double, nano>(t1 - t0).count() / systems;
+        double fixedNs = chrono::duration<double, nano>(t2 - t1).count() / systems;
+        cout << setw(4) << n << fixed << setprecision(1) << setw(14) << genericNs << setw(12) << fixedNs
+             << setw(9) << setprecision(2) << genericNs / fixedNs << "x" << defaultfloat << setprecision(3)
+             << setw(14) << maxDiff << setprecision(6) << endl;
+    }
+    if (failures > 0) cerr << failures << " singular systems in the benchmark set" << endl;
+    return 0;
+}
+
+// ============================================================================
+// Batch Mode: a directory or manifest of systems, loading overlapped with solving
+// ============================================================================
+
+// *.mtx / *.bin files of a directory in name order, or the entries of a manifest
+// (one path per line, '#' comments, relative paths resolved against the manifest)
+static vector<string> collect_batch_inputs(const string& path) {
+    namespace fs = std::filesystem;
+    vector<string> inputs;
+    error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".mtx" || extension == ".bin")) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+    ifstream manifest(path);
+    if (!manifest.is_open()) return inputs;
+    fs::path base = fs::path(path).parent_path();
+    string line;
+    while (getline(manifest, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == string::npos || line[begin] == '#') continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        fs::path entry = line.substr(begin, end - begin + 1);
+        inputs.push_back(entry.is_absolute() ? entry.string() : (base / entry).string());
+    }
+    return inputs;
+}
+
+/**
+ * @brief One system in flight. Two slots alternate between the loader and the solver;
+ * their buffers keep their capacity, so after warm-up they are sized to the largest n seen.
+ */
+struct BatchSlot {
+    string path;
+    string error;                     // empty when the system is ready to solve
+    int n = 0;
+    size_t nnz = 0;
+    double loadMs = 0.0;
+    DenseBuffer dense;                // column-major A
+    bool hasCsr = false;              // .mtx inputs verify from the CSR, binary ones from the dense copy
+    CompressedSparseRowMatrix csr;
+};
+
+// Runs on the loader thread: read + convert into the slot the solver is not using
+static void load_batch_input(const string& path, BatchSlot& slot) {
+    // Keep the conversion to one thread so it does not compete with the factorisation's team
+    omp_set_num_threads(1);
+    auto t0 = chrono::high_resolution_clock::now();
+    slot.path = path;
+    slot.error.clear();
+    slot.n = 0;
+    slot.nnz = 0;
+    slot.hasCsr = false;
+    if (is_dense_binary_file(path)) {
+        MappedDenseMatrix mapped;
+        if (!mapped.open(path)) {
+            slot.error = "unreadable";
+        } else if (mapped.getRows() != mapped.getColumns()) {
+            slot.error = "not square";
+        } else {
+            slot.n = mapped.getRows();
+            slot.nnz = size_t(slot.n) * size_t(slot.n);
+            slot.dense.resize(slot.nnz);
+            copy(mapped.data(), mapped.data() + slot.nnz, slot.dense.begin());
+        }
+    } else {
+        int nrows = 0, ncols = 0;
+        vector<CoordinateEntry> coo;
+        if (!MatrixMarketReader::readMatrixMarketFile(path, nrows, ncols, coo)) {
+            slot.error = "unreadable";
+        } else if (nrows != ncols) {
+            slot.error = "not square";
+        } else {
+            slot.n = nrows;
+            slot.csr = coo_to_csr(nrows, ncols, coo);
+            slot.nnz = slot.csr.getNumberOfNonZeros();
+            slot.hasCsr = true;
+            coo_to_dense_colmaj(nrows, ncols, coo, slot.dense);
+        }
+    }
+    auto t1 = chrono::high_resolution_clock::now();
+    slot.loadMs = chrono::duration<double, milli>(t1 - t0).count();
+}
+
+static void print_batch_row(const BatchSlot& slot, const string& backend, double ms, const ResidualReport* residual,
+                            const string& status) {
+    string name = std::filesystem::path(slot.path).filename().string();
+    cout << left << setw(28) << name << right << setw(8) << slot.n << setw(12) << slot.nnz
+         << setw(11) << fixed << setprecision(2) << slot.loadMs << "  " << left << setw(8) << backend << right;
+    if (residual == nullptr) {
+        cout << "  " << status << defaultfloat << setprecision(6) << endl;
+        return;
+    }
+    double gflops = ms > 0.0 ? (2.0 / 3.0) * double(slot.n) * double(slot.n) * double(slot.n) / (ms * 1e6) : 0.0;
+    cout << setw(12) << ms << setw(10) << gflops << defaultfloat << setprecision(6)
+         << setw(14) << residual->norm << setw(14) << residual->relative << endl;
+}
+
+/**
+ * @brief Solve every system of a directory or manifest with the CPU LU and GPU backends
+ *
+ * While system i is factorised, system i+1 is read and densified on a background thread.
+ * The LU workspace, x and b are reused across systems as well.
+ */
+static int run_batch(const SolverOptions& opts) {
+    vector<string> inputs = collect_batch_inputs(opts.batchPath);
+    if (inputs.empty()) {
+        cerr << "No .mtx/.bin inputs found in: " << opts.batchPath << endl;
+        return 1;
+    }
+    cout << "=== BATCH (" << inputs.size() << " systems, " << omp_get_max_threads() << " solver threads) ===" << endl;
+    cout << left << setw(28) << "Matrix" << right << setw(8) << "n" << setw(12) << "nnz" << setw(11) << "Load (ms)"
+         << "  " << left << setw(8) << "Backend" << right << setw(12) << "Time (ms)" << setw(10) << "GFLOP/s"
+         << setw(14) << "Residual" << setw(14) << "Relative" << endl;
+
+    array<BatchSlot, 2> slots;
+    DenseLUFactorization<double> F;
+    vector<double> b, x;
+    int failures = 0, skipped = 0;
+    double loadTotal = 0.0, solveTotal = 0.0;
+    auto tStart = chrono::high_resolution_clock::now();
+
+    future<void> pending = async(launch::async, load_batch_input, cref(inputs[0]), ref(slots[0]));
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        pending.get();
+        BatchSlot& slot = slots[i % 2];
+        if (i + 1 < inputs.size()) {
+            pending = async(launch::async, load_batch_input, cref(inputs[i + 1]), ref(slots[(i + 1) % 2]));
+        }
+        loadTotal += slot.loadMs;
+        if (!slot.error.empty()) {
+            print_batch_row(slot, "-", 0.0, nullptr, "skipped (" + slot.error + ")");
+            if (slot.error == "not square") ++skipped; else ++failures;
+            continue;
+        }
+        int n = slot.n;
+        auto verify = [&](const vector<double>& solution) {
+            return slot.hasCsr ? compute_residual(slot.csr, solution, b)
+                               : compute_residual_dense(n, slot.dense.data(), solution, b);
+        };
+        b = generate_random_b(n, 1337);
+
+        auto t0 = chrono::high_resolution_clock::now();
+        bool ok = factorize_dense_lu(n, slot.dense.data(), F);
+        if (ok) {
+            x = b;
+            solve_dense_lu(F, x);
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        double cpuMs = chrono::duration<double, milli>(t1 - t0).count();
+        solveTotal += cpuMs;
+        if (ok) {
+            ResidualReport residual = verify(x);
+            print_batch_row(slot, "cpu-lu", cpuMs, &residual, "");
+        } else {
+            print_batch_row(slot, "cpu-lu", cpuMs, nullptr, "failed (singular?)");
+            ++failures;
+        }
+
+        x.assign(n, 0.0);
+        float gpuMs = 0.0f;
+        if (solve_dense_gpu(n, slot.dense.data(), b.data(), x.data(), 1, &gpuMs)) {
+            solveTotal += gpuMs;
+            ResidualReport residual = verify(x);
+            print_batch_row(slot, "gpu", gpuMs, &residual, "");
+        } else {
+            print_batch_row(slot, "gpu", 0.0, nullptr, "unavailable");
+        }
+    }
+    auto tEnd = chrono::high_resolution_clock::now();
+    cout << "Batch wall time (ms): " << chrono::duration<double, milli>(tEnd - tStart).count()
+         << ", load total: " << loadTotal << ", solve total: " << solveTotal
+         << ", skipped: " << skipped << ", failed: " << failures << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    SolverOptions opts;
+    if (!parse_options(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (opts.distributed) {
+#ifdef LAB2_WITH_MPI
+        return run_distributed_lu(argc, argv, opts.matrixPath, opts.weakScalingBase, opts.distributedBlock);
+#else
+        cerr << "--distributed needs the MPI build (lab2_mpi target)" << endl;
+        return 1;
+#endif
+    }
+    if (opts.smallBenchSystems > 0) {
+        return run_small_system_benchmark(opts.smallBenchSystems);
+    }
+    if (!opts.batchPath.empty()) {
+        return run_batch(opts);
+    }
+    string matrixPath = opts.matrixPath;
+    unique_ptr<PhaseProfiler> profiler;
+    if (opts.perf) {
+        profiler = make_unique<PhaseProfiler>();
+        if (!profiler->open()) {
+            cerr << "Hardware counters unavailable (" << profiler->getUnavailableReason()
+                 << "), reporting time and GFLOP/s only" << endl;
+        }
+        if (opts.hodlr) {
+            cerr << "--perf counts the dense LU phases; the HODLR comparison is timed without counters" << endl;
+        }
+    }
+
+    // Binary dense input is mapped and handed to the solvers without any conversion
+    if (is_dense_binary_file(matrixPath)) {
+        auto t0 = chrono::high_resolution_clock::now();
+        MappedDenseMatrix mapped;
+        if (!mapped.open(matrixPath)) {
+            cerr << "Failed to map binary matrix: " << matrixPath << endl;
+            return 1;
+        }
+        auto t1 = chrono::high_resolution_clock::now();
+        if (mapped.getRows() != mapped.getColumns()) {
+            cerr << "Matrix must be square for this solver" << endl;
+            return 1;
+        }
+        int n = mapped.getRows();
+        if (opts.method != "dense") {
+            cerr << "--method " << opts.method << " needs Matrix Market input; running the dense solvers" << endl;
+        }
+        cout << "Mapped binary dense matrix n=" << n << " (ms): "
+             << chrono::duration<double, milli>(t1 - t0).count() << endl;
+        return run_dense_solvers(opts, n, mapped.data(), [&](const vector<double>& x, const vector<double>& b) {
+            return compute_residual_dense(n, mapped.data(), x, b);
+        }, profiler.get(), 2.0 * double(n) * double(n));
+    }
+
+    auto tRead0 = chrono::high_resolution_clock::now();
+    int nrows = 0, ncols = 0;
+    vector<CoordinateEntry> coo;
+    if (!MatrixMarketReader::readMatrixMarketFile(matrixPath, nrows, ncols, coo)) {
+        cerr << "Failed to read matrix: " << matrixPath << endl;
+        return 1;
+    }
+    auto tRead1 = chrono::high_resolution_clock::now();
+    cout << "Read Matrix Market (ms): " << chrono::duration<double, milli>(tRead1 - tRead0).count() << endl;
+    if (nrows > ncols) {
+        if (profiler != nullptr) cerr << "--perf is not supported on the least-squares path; ignoring it" << endl;
+        return run_least_squares(nrows, ncols, coo, opts.sketch, opts.sketchOptions);
+    }
+    if (nrows != ncols) {
+        cerr << "Underdetermined systems (rows < columns) are not supported" << endl;
+        return 1;
+    }
+    int n = nrows;
+    if (opts.method == "auto") {
+        return run_auto_solver(opts, n, coo);
+    }
+    if (opts.method != "dense") {
+        return run_krylov_solver(opts, n, coo);
+    }
+
+    Bandwidth bw = detect_bandwidth(coo);
+    cout << "Detected bandwidth: kl=" << bw.lower << ", ku=" << bw.upper << " (n=" << n << ")" << endl;
+    if (opts.writeBinaryPath.empty() && opts.allowBandPath && band_path_pays_off(n, bw)) {
+        if (profiler != nullptr) cerr << "--perf is not supported on the banded path (use --no-band); ignoring it" << endl;
+        return run_banded_solver(n, coo, bw);
+    }
+    cout << "Path: dense LU" << endl;
+
+    // Residuals are verified from the CSR in O(nnz); the dense copy only feeds the solvers
+    CompressedSparseRowMatrix csr = coo_to_csr(n, n, coo);
+    DenseBuffer A;
+    auto tConvert0 = chrono::high_resolution_clock::now();
+    auto convert = [&] { coo_to_dense_colmaj(n, n, coo, A); };
+    if (profiler != nullptr) profiler->measure("conversion", 0.0, convert); else convert();
+    auto tConvert1 = chrono::high_resolution_clock::now();
+    cout << "COO to dense (ms): " << chrono::duration<double, milli>(tConvert1 - tConvert0).count() << endl;
+
+    if (!opts.writeBinaryPath.empty()) {
+        if (!write_dense_binary(opts.writeBinaryPath, n, n, A.data())) {
+            cerr << "Failed to write binary matrix: " << opts.writeBinaryPath << endl;
+            return 1;
+        }
+        cout << "Wrote binary dense matrix: " << opts.writeBinaryPath << endl;
+        return 0;
+    }
+
+    return run_dense_solvers(opts, n, A.data(), [&](const vector<double>& x, const vector<double>& b) {
+        return compute_residual(csr, x, b);
+    }, profiler.get(), 2.0 * double(csr.getNumberOfNonZeros()));
+}
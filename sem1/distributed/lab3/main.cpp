@@ -6,6 +6,27 @@
 #include <cmath>
 #include <chrono>
 #include <iomanip>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <csignal>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <omp.h>
 
 struct StockData {
@@ -46,6 +67,346 @@ std::vector<StockData> readCSV(const std::string& filename) {
     return data;
 }
 
+// Days since 1970-01-01 for a proleptic Gregorian date
+inline int32_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int32_t>(dayOfEra) - 719468;
+}
+
+// Inverse of daysFromCivil, formatted as YYYY-MM-DD
+std::string formatDay(int32_t days) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned mp = (5 * dayOfYear + 2) / 153;
+    unsigned day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    int year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u", year, month, day);
+    return buffer;
+}
+
+// Column-per-field view of the CSV; dates are day numbers (see daysFromCivil)
+struct StockColumns {
+    std::vector<int32_t> day;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> adjClose;
+    std::vector<long> volume;
+    size_t skippedRows = 0; // lines that did not parse as a full record
+
+    size_t size() const { return close.size(); }
+    void resize(size_t n) {
+        day.resize(n); open.resize(n); high.resize(n); low.resize(n);
+        close.resize(n); adjClose.resize(n); volume.resize(n);
+    }
+};
+
+// Parse one "Date,Open,High,Low,Close,Adj Close,Volume" line into row `row`
+bool parseStockLine(const char* begin, const char* end, StockColumns& columns, size_t row) {
+    if (end > begin && end[-1] == '\r') end--;
+    const char* p = begin;
+    int year = 0, month = 0, day = 0;
+    auto field = [&](auto& value) {
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return true;
+    };
+    auto expect = [&](char c) {
+        if (p >= end || *p != c) return false;
+        p++;
+        return true;
+    };
+    if (!(field(year) && expect('-') && field(month) && expect('-') && field(day) && expect(','))) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    columns.day[row] = daysFromCivil(year, month, day);
+    return field(columns.open[row]) && expect(',')
+        && field(columns.high[row]) && expect(',')
+        && field(columns.low[row]) && expect(',')
+        && field(columns.close[row]) && expect(',')
+        && field(columns.adjClose[row]) && expect(',')
+        && field(columns.volume[row]) && p == end;
+}
+
+// Read the CSV through mmap: the body is split at newline boundaries into one chunk
+// per thread; pass 1 counts lines so every chunk knows its output offset, pass 2
+// parses in place with from_chars. Returns no rows if the file cannot be mapped.
+StockColumns readCSV_Mapped(const std::string& filename, int numThreads) {
+    StockColumns columns;
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return columns;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return columns;
+    }
+    size_t fileSize = info.st_size;
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return columns;
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    const char* text = static_cast<const char*>(mapping);
+    const char* fileEnd = text + fileSize;
+
+    // Skip the header
+    const char* body = static_cast<const char*>(std::memchr(text, '\n', fileSize));
+    body = body ? body + 1 : fileEnd;
+
+    // Chunk c covers [bounds[c], bounds[c + 1]) and always starts at a line start
+    int chunks = std::max(1, numThreads);
+    std::vector<const char*> bounds(chunks + 1);
+    size_t bodySize = fileEnd - body;
+    bounds[0] = body;
+    bounds[chunks] = fileEnd;
+    for (int c = 1; c < chunks; c++) {
+        const char* guess = body + bodySize * c / chunks;
+        guess = std::max(guess, bounds[c - 1]);
+        const char* newline = static_cast<const char*>(std::memchr(guess, '\n', fileEnd - guess));
+        bounds[c] = newline ? newline + 1 : fileEnd;
+    }
+    auto forEachLine = [&](int c, auto&& visit) {
+        const char* p = bounds[c];
+        while (p < bounds[c + 1]) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', bounds[c + 1] - p));
+            const char* lineEnd = newline ? newline : bounds[c + 1];
+            if (lineEnd > p && !(lineEnd - p == 1 && *p == '\r')) visit(p, lineEnd);
+            p = lineEnd + 1;
+        }
+    };
+
+    // Pass 1: non-empty lines per chunk -> output offsets
+    std::vector<size_t> offset(chunks + 1, 0);
+    #pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int c = 0; c < chunks; c++) {
+        size_t lines = 0;
+        forEachLine(c, [&](const char*, const char*) { lines++; });
+        offset[c + 1] = lines;
+    }
+    for (int c = 0; c < chunks; c++) offset[c + 1] += offset[c];
+    columns.resize(offset[chunks]);
+
+    // Pass 2: parse; rows that fail are dropped by not advancing the cursor
+    std::vector<size_t> parsed(chunks, 0);
+    #pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int c = 0; c < chunks; c++) {
+        size_t row = offset[c];
+        forEachLine(c, [&](const char* lineBegin, const char* lineEnd) {
+            if (parseStockLine(lineBegin, lineEnd, columns, row)) row++;
+        });
+        parsed[c] = row - offset[c];
+    }
+    munmap(mapping, fileSize);
+
+    // Close the gaps left by skipped rows (chunks only ever move left)
+    size_t rows = parsed[0];
+    for (int c = 1; c < chunks; c++) {
+        if (rows != offset[c]) {
+            auto shift = [&](auto& column) {
+                std::copy(column.begin() + offset[c], column.begin() + offset[c] + parsed[c], column.begin() + rows);
+            };
+            shift(columns.day); shift(columns.open); shift(columns.high); shift(columns.low);
+            shift(columns.close); shift(columns.adjClose); shift(columns.volume);
+        }
+        rows += parsed[c];
+    }
+    columns.skippedRows = offset[chunks] - rows;
+    columns.resize(rows);
+    return columns;
+}
+
+// Column-oriented time series with 64-byte-aligned columns. The data lives either in
+// an owned buffer or in a read-only mapping of the binary cache file; in the mapped
+// case only the pages of the columns that are actually read are ever faulted in.
+class TimeSeriesTable {
+public:
+    enum Column { Day, Open, High, Low, Close, AdjClose, Volume, ColumnCount };
+
+    TimeSeriesTable() = default;
+    TimeSeriesTable(const TimeSeriesTable&) = delete;
+    TimeSeriesTable& operator=(const TimeSeriesTable&) = delete;
+    TimeSeriesTable(TimeSeriesTable&& other) noexcept { *this = std::move(other); }
+    TimeSeriesTable& operator=(TimeSeriesTable&& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(bytes, other.bytes);
+        std::swap(mapped, other.mapped);
+        std::swap(rows, other.rows);
+        std::swap(offsets, other.offsets);
+        std::swap(skipped, other.skipped);
+        return *this;
+    }
+    ~TimeSeriesTable() { release(); }
+
+    size_t size() const { return rows; }
+    bool fromCache() const { return mapped; }
+    size_t skippedRows() const { return skipped; }
+    size_t byteSize() const { return bytes; }
+
+    const int32_t* day() const { return columnData<int32_t>(Day); }
+    const double* open() const { return columnData<double>(Open); }
+    const double* high() const { return columnData<double>(High); }
+    const double* low() const { return columnData<double>(Low); }
+    const double* close() const { return columnData<double>(Close); }
+    const double* adjClose() const { return columnData<double>(AdjClose); }
+    const int64_t* volume() const { return columnData<int64_t>(Volume); }
+
+    // Copy of one price column, for the std::vector based analysis functions
+    std::vector<double> priceColumn(Column column) const {
+        const double* values = columnData<double>(column);
+        return std::vector<double>(values, values + rows);
+    }
+
+    // Load `csvPath` through its binary cache (`csvPath + ".cols"`): a cache that matches
+    // the CSV's size and modification time is mapped, otherwise the CSV is parsed with
+    // readCSV_Mapped and the cache is rewritten for the next run.
+    static TimeSeriesTable load(const std::string& csvPath, int numThreads) {
+        std::string cachePath = csvPath + ".cols";
+        struct stat source;
+        if (stat(csvPath.c_str(), &source) != 0) return {};
+        TimeSeriesTable table = mapCache(cachePath, source);
+        if (table.mapped) return table;
+
+        StockColumns columns = readCSV_Mapped(csvPath, numThreads);
+        table = fromColumns(columns);
+        if (!table.base) {
+            std::cerr << "Cannot allocate the column table for " << csvPath << " (" << columns.size() << " rows)" << std::endl;
+            return {};
+        }
+        table.skipped = columns.skippedRows;
+        // An empty parse or a partly skipped CSV is not worth caching
+        if (table.size() > 0 && columns.skippedRows == 0) table.writeCache(cachePath, source);
+        return table;
+    }
+
+private:
+    static constexpr size_t kAlignment = 64;
+    static constexpr uint64_t kMagic = 0x534c4f433342414cULL; // "LAB3COLS"
+    static constexpr uint32_t kVersion = 1;
+
+    // On-disk header, padded so the first column starts on a 64-byte boundary
+    struct alignas(kAlignment) CacheHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t columnCount;
+        uint64_t rows;
+        uint64_t sourceSize;
+        int64_t sourceMtimeSec;
+        int64_t sourceMtimeNsec;
+        uint64_t offsets[ColumnCount];
+    };
+
+    char* base = nullptr;
+    size_t bytes = 0;
+    bool mapped = false;
+    size_t rows = 0;
+    size_t skipped = 0;
+    std::array<size_t, ColumnCount> offsets = {};
+
+    static size_t elementSize(int column) { return column == Day ? sizeof(int32_t) : 8; }
+    static size_t alignUp(size_t value) { return (value + kAlignment - 1) / kAlignment * kAlignment; }
+
+    template <typename T>
+    const T* columnData(Column column) const {
+        return reinterpret_cast<const T*>(base + offsets[column]);
+    }
+
+    // Column offsets after the header for `n` rows; returns the total size
+    size_t layout(size_t n) {
+        rows = n;
+        size_t position = sizeof(CacheHeader);
+        for (int c = 0; c < ColumnCount; c++) {
+            offsets[c] = position;
+            position = alignUp(position + n * elementSize(c));
+        }
+        return position;
+    }
+
+    void release() {
+        if (!base) return;
+        if (mapped) munmap(base, bytes);
+        else std::free(base);
+        base = nullptr;
+    }
+
+    static TimeSeriesTable fromColumns(const StockColumns& columns) {
+        TimeSeriesTable table;
+        table.bytes = table.layout(columns.size());
+        table.base = static_cast<char*>(std::aligned_alloc(kAlignment, table.bytes));
+        if (!table.base) return {};
+        std::memset(table.base, 0, sizeof(CacheHeader));
+        auto put = [&](Column column, const auto& values) {
+            std::memcpy(table.base + table.offsets[column], values.data(), values.size() * elementSize(column));
+        };
+        put(Day, columns.day);
+        put(Open, columns.open);
+        put(High, columns.high);
+        put(Low, columns.low);
+        put(Close, columns.close);
+        put(AdjClose, columns.adjClose);
+        for (size_t i = 0; i < columns.size(); i++)
+            reinterpret_cast<int64_t*>(table.base + table.offsets[Volume])[i] = columns.volume[i];
+        return table;
+    }
+
+    static TimeSeriesTable mapCache(const std::string& cachePath, const struct stat& source) {
+        TimeSeriesTable table;
+        int fd = ::open(cachePath.c_str(), O_RDONLY);
+        if (fd < 0) return table;
+        CacheHeader header;
+        bool valid = pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+            && header.magic == kMagic && header.version == kVersion && header.columnCount == ColumnCount
+            && header.sourceSize == static_cast<uint64_t>(source.st_size)
+            && header.sourceMtimeSec == source.st_mtim.tv_sec
+            && header.sourceMtimeNsec == source.st_mtim.tv_nsec;
+        struct stat info;
+        size_t expected = valid ? table.layout(header.rows) : 0;
+        valid = valid && fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == expected
+            && std::equal(table.offsets.begin(), table.offsets.end(), header.offsets);
+        if (valid) {
+            void* mapping = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping != MAP_FAILED) {
+                table.base = static_cast<char*>(mapping);
+                table.bytes = expected;
+                table.mapped = true;
+            }
+        }
+        ::close(fd);
+        if (!table.mapped) table.rows = 0;
+        return table;
+    }
+
+    // Written to a temporary name and renamed, so a reader never maps a partial file
+    void writeCache(const std::string& cachePath, const struct stat& source) {
+        CacheHeader header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.columnCount = ColumnCount;
+        header.rows = rows;
+        header.sourceSize = source.st_size;
+        header.sourceMtimeSec = source.st_mtim.tv_sec;
+        header.sourceMtimeNsec = source.st_mtim.tv_nsec;
+        std::copy(offsets.begin(), offsets.end(), header.offsets);
+        std::memcpy(base, &header, sizeof(header));
+
+        std::string temporary = cachePath + ".tmp";
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(base, bytes);
+        out.close();
+        if (out) std::rename(temporary.c_str(), cachePath.c_str());
+        else std::remove(temporary.c_str());
+    }
+};
+
 // Simple Moving Average (SMA) - parallel version
 std::vector<double> calculateSMA_Parallel(const std::vector<double>& prices, int windowSize, int numThreads) {
     int n = prices.size();
@@ -88,6 +449,601 @@ std::vector<double> calculateWMA_Parallel(const std::vector<double>& prices, int
     return wma;
 }
 
+// Compensated prefix sums: prefix[i] = sum of values[0..i-1] kept as value + error word
+// (Neumaier summation), so differences of far-apart prefixes keep full double precision
+struct CompensatedPrefix {
+    std::vector<double> sum;
+    std::vector<double> error;
+
+    double range(size_t begin, size_t end) const {
+        return (sum[end] - sum[begin]) + (error[end] - error[begin]);
+    }
+};
+
+// Neumaier step: adds value to (sum, error) without losing the low-order bits
+inline void compensatedAdd(double& sum, double& error, double value) {
+    double t = sum + value;
+    if (std::abs(sum) >= std::abs(value)) {
+        error += (sum - t) + value;
+    } else {
+        error += (value - t) + sum;
+    }
+    sum = t;
+}
+
+// Two-pass blocked parallel prefix sum: block totals, a short serial scan of the totals,
+// then every thread rescans its own block starting from its offset
+CompensatedPrefix computePrefixSum_Parallel(const std::vector<double>& values, int numThreads) {
+    size_t n = values.size();
+    CompensatedPrefix prefix;
+    prefix.sum.assign(n + 1, 0.0);
+    prefix.error.assign(n + 1, 0.0);
+
+    std::vector<double> blockSum(numThreads + 1, 0.0), blockError(numThreads + 1, 0.0);
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+        int tid = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        size_t begin = n * tid / threads, end = n * (tid + 1) / threads;
+
+        double s = 0.0, e = 0.0;
+        for (size_t i = begin; i < end; i++) compensatedAdd(s, e, values[i]);
+        blockSum[tid + 1] = s;
+        blockError[tid + 1] = e;
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            for (int t = 1; t <= threads; t++) {
+                double carry = blockError[t];
+                double total = blockSum[t - 1];
+                double totalError = blockError[t - 1];
+                compensatedAdd(total, totalError, blockSum[t]);
+                blockSum[t] = total;
+                blockError[t] = totalError + carry;
+            }
+        }
+
+        s = blockSum[tid];
+        e = blockError[tid];
+        for (size_t i = begin; i < end; i++) {
+            compensatedAdd(s, e, values[i]);
+            prefix.sum[i + 1] = s;
+            prefix.error[i + 1] = e;
+        }
+    }
+
+    return prefix;
+}
+
+// Simple Moving Average (SMA) - O(n) from prefix sums, independent of the window size
+std::vector<double> calculateSMA_PrefixSum(const std::vector<double>& prices, int windowSize, int numThreads) {
+    int n = prices.size();
+    std::vector<double> sma(n, 0.0);
+    CompensatedPrefix prefix = computePrefixSum_Parallel(prices, numThreads);
+
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (int i = windowSize - 1; i < n; i++) {
+        sma[i] = prefix.range(i + 1 - windowSize, i + 1) / windowSize;
+    }
+
+    return sma;
+}
+
+// Weighted Moving Average (WMA) - O(n) running-sum recurrence, independent of the window size.
+// With S = plain window sum and T = weighted window sum, sliding by one bar gives
+//   T' = T + w * x_new - S,   S' = S + x_new - x_old.
+// Each thread seeds its block of outputs with one direct window evaluation, then slides;
+// both sums are carried with Neumaier compensation, and a fresh seed every
+// max(4096, 16 * w) outputs (at most 1/16 extra work) caps the drift at rounding level.
+std::vector<double> calculateWMA_Recurrence(const std::vector<double>& prices, int windowSize, int numThreads) {
+    int n = prices.size();
+    std::vector<double> wma(n, 0.0);
+    if (windowSize <= 0 || windowSize > n) return wma;
+
+    double weightSum = windowSize * (windowSize + 1) / 2.0;
+    int first = windowSize - 1;
+    int outputs = n - first;
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+        int tid = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        int begin = first + (int)((long long)outputs * tid / threads);
+        int end = first + (int)((long long)outputs * (tid + 1) / threads);
+
+        int reseedInterval = std::max(4096, 16 * windowSize);
+        for (int seed = begin; seed < end; seed += reseedInterval) {
+            double plain = 0.0, plainError = 0.0, weighted = 0.0, weightedError = 0.0;
+            for (int j = 0; j < windowSize; j++) {
+                double x = prices[seed - windowSize + 1 + j];
+                compensatedAdd(plain, plainError, x);
+                compensatedAdd(weighted, weightedError, x * (j + 1));
+            }
+            wma[seed] = (weighted + weightedError) / weightSum;
+
+            int stop = std::min(end, seed + reseedInterval);
+            for (int i = seed + 1; i < stop; i++) {
+                double incoming = prices[i];
+                compensatedAdd(weighted, weightedError, windowSize * incoming);
+                compensatedAdd(weighted, weightedError, -(plain + plainError));
+                compensatedAdd(plain, plainError, incoming);
+                compensatedAdd(plain, plainError, -prices[i - windowSize]);
+                wma[i] = (weighted + weightedError) / weightSum;
+            }
+        }
+    }
+
+    return wma;
+}
+
+// ============ Linear-recurrence scan engine (EMA family) ============
+
+// K-state first-order linear recurrence: s[i] = transition * s[i-1] + input * x[i]
+template <int K>
+struct LinearRecurrence {
+    double transition[K][K];
+    double input[K];
+};
+
+// Segment map s_end = power * s_start + offset (the affine composition of a segment's steps)
+template <int K>
+struct AffineMap {
+    double power[K][K];
+    double offset[K];
+};
+
+template <int K>
+void multiplyMatrices(const double a[K][K], const double b[K][K], double out[K][K]) {
+    for (int r = 0; r < K; r++) {
+        for (int c = 0; c < K; c++) {
+            double sum = 0.0;
+            for (int k = 0; k < K; k++) sum += a[r][k] * b[k][c];
+            out[r][c] = sum;
+        }
+    }
+}
+
+// transition^steps by repeated squaring
+template <int K>
+void matrixPower(const double m[K][K], long long steps, double out[K][K]) {
+    double base[K][K], tmp[K][K];
+    for (int r = 0; r < K; r++) {
+        for (int c = 0; c < K; c++) {
+            base[r][c] = m[r][c];
+            out[r][c] = (r == c) ? 1.0 : 0.0;
+        }
+    }
+    while (steps > 0) {
+        if (steps & 1) {
+            multiplyMatrices<K>(out, base, tmp);
+            std::copy(&tmp[0][0], &tmp[0][0] + K * K, &out[0][0]);
+        }
+        multiplyMatrices<K>(base, base, tmp);
+        std::copy(&tmp[0][0], &tmp[0][0] + K * K, &base[0][0]);
+        steps >>= 1;
+    }
+}
+
+/**
+ * Parallel associative scan of a linear recurrence. Output r is projections[r] . s[i].
+ *
+ * The series is cut into numThreads * kScanLanes equal segments; each thread advances its
+ * kScanLanes segments in lockstep so the lane loop vectorises. Pass 1 runs every segment
+ * from a zero state (its affine offset), a short serial loop composes the segment maps
+ * into true start states, and pass 2 reruns the segments from those states writing the
+ * outputs. Work is 2n K^2 for any n, with no sequential dependence across segments.
+ * With one thread the scan only doubles the work, so the plain recurrence runs instead.
+ */
+constexpr int kScanLanes = 8;
+constexpr int kScanTile = 64;
+
+// Advances the kScanLanes segments of one group by `steps` steps. x is copied tile by tile
+// into tile[t][lane] so the lane loop reads and writes unit-stride; with RecordStates every
+// tile's states land in states[t][r][lane] and visitTile(t0, count, states) consumes them.
+template <int K, bool RecordStates, typename TileVisitor>
+void advanceScanLanes(const LinearRecurrence<K>& system, const double* x, const long long begin[kScanLanes],
+                      long long steps, double state[K][kScanLanes], TileVisitor&& visitTile) {
+    double transition[K][K], input[K];
+    for (int r = 0; r < K; r++) {
+        input[r] = system.input[r];
+        for (int c = 0; c < K; c++) transition[r][c] = system.transition[r][c];
+    }
+    alignas(64) double tile[kScanTile][kScanLanes];
+    alignas(64) double states[RecordStates ? kScanTile : 1][K][kScanLanes];
+    for (long long t0 = 0; t0 < steps; t0 += kScanTile) {
+        int count = static_cast<int>(std::min<long long>(kScanTile, steps - t0));
+        for (int lane = 0; lane < kScanLanes; lane++) {
+            const double* source = x + begin[lane] + t0;
+            for (int t = 0; t < count; t++) tile[t][lane] = source[t];
+        }
+        for (int t = 0; t < count; t++) {
+            #pragma omp simd
+            for (int lane = 0; lane < kScanLanes; lane++) {
+                double xi = tile[t][lane];
+                double next[K];
+                for (int r = 0; r < K; r++) {
+                    double v = input[r] * xi;
+                    for (int c = 0; c < K; c++) v += transition[r][c] * state[c][lane];
+                    next[r] = v;
+                }
+                for (int r = 0; r < K; r++) {
+                    state[r][lane] = next[r];
+                    if constexpr (RecordStates) states[t][r][lane] = next[r];
+                }
+            }
+        }
+        if constexpr (RecordStates) visitTile(t0, count, states);
+    }
+}
+
+template <int K>
+std::vector<std::vector<double>> scanLinearRecurrence_Parallel(const LinearRecurrence<K>& system,
+                                                               const std::vector<double>& x,
+                                                               const std::array<double, K>& initial,
+                                                               const std::vector<std::array<double, K>>& projections,
+                                                               int numThreads) {
+    long long n = x.size();
+    // Sized in place: copying a zeroed prototype would touch every output page twice
+    int numOutputs = projections.size();
+    std::vector<std::vector<double>> outputs(numOutputs);
+    std::vector<double*> outputData(numOutputs);
+    for (int o = 0; o < numOutputs; o++) {
+        outputs[o].resize(n);
+        outputData[o] = outputs[o].data();
+    }
+    if (n == 0) return outputs;
+
+    // Local copies: the output stores cannot alias them, so they stay in registers
+    double transition[K][K], input[K];
+    for (int r = 0; r < K; r++) {
+        input[r] = system.input[r];
+        for (int c = 0; c < K; c++) transition[r][c] = system.transition[r][c];
+    }
+
+    // One step of the recurrence on a single state vector, for the serial path and segment tails
+    auto step = [&](double s[K], double xi) {
+        double next[K];
+        for (int r = 0; r < K; r++) {
+            double v = input[r] * xi;
+            for (int c = 0; c < K; c++) v += transition[r][c] * s[c];
+            next[r] = v;
+        }
+        for (int r = 0; r < K; r++) s[r] = next[r];
+    };
+    auto project = [&](const double s[K], long long i) {
+        for (int o = 0; o < numOutputs; o++) {
+            double y = 0.0;
+            for (int r = 0; r < K; r++) y += projections[o][r] * s[r];
+            outputData[o][i] = y;
+        }
+    };
+
+    if (numThreads <= 1) {
+        double s[K];
+        for (int r = 0; r < K; r++) s[r] = initial[r];
+        for (long long i = 0; i < n; i++) {
+            step(s, x[i]);
+            project(s, i);
+        }
+        return outputs;
+    }
+
+    long long groups = numThreads;
+    long long segments = std::min<long long>(groups * kScanLanes, n);
+    groups = (segments + kScanLanes - 1) / kScanLanes;
+    long long segmentLength = (n + segments - 1) / segments;
+    auto segmentBegin = [&](long long g) { return std::min(n, g * segmentLength); };
+    auto noTiles = [](long long, int, const auto&) {};
+
+    // Pass 1: per-segment offsets from a zero state, lanes in lockstep
+    std::vector<AffineMap<K>> maps(groups * kScanLanes);
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (long long group = 0; group < groups; group++) {
+        long long begin[kScanLanes], length[kScanLanes];
+        double state[K][kScanLanes] = {};
+        for (int lane = 0; lane < kScanLanes; lane++) {
+            long long g = group * kScanLanes + lane;
+            begin[lane] = segmentBegin(g);
+            length[lane] = segmentBegin(g + 1) - begin[lane];
+        }
+        // Only the last lanes can be short: run the common length without masking
+        long long common = *std::min_element(length, length + kScanLanes);
+        advanceScanLanes<K, false>(system, x.data(), begin, common, state, noTiles);
+        for (int lane = 0; lane < kScanLanes; lane++) {
+            double s[K];
+            for (int r = 0; r < K; r++) s[r] = state[r][lane];
+            for (long long t = common; t < length[lane]; t++) step(s, x[begin[lane] + t]);
+            AffineMap<K>& map = maps[group * kScanLanes + lane];
+            matrixPower<K>(system.transition, length[lane], map.power);
+            for (int r = 0; r < K; r++) map.offset[r] = s[r];
+        }
+    }
+
+    // Compose the segment maps: start state of every segment
+    std::vector<std::array<double, K>> starts(groups * kScanLanes);
+    std::array<double, K> current = initial;
+    for (size_t g = 0; g < starts.size(); g++) {
+        starts[g] = current;
+        std::array<double, K> next;
+        for (int r = 0; r < K; r++) {
+            double v = maps[g].offset[r];
+            for (int c = 0; c < K; c++) v += maps[g].power[r][c] * current[c];
+            next[r] = v;
+        }
+        current = next;
+    }
+
+    // Pass 2: rerun every segment from its true start, writing the projected outputs
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (long long group = 0; group < groups; group++) {
+        long long begin[kScanLanes], length[kScanLanes];
+        double state[K][kScanLanes];
+        for (int lane = 0; lane < kScanLanes; lane++) {
+            long long g = group * kScanLanes + lane;
+            begin[lane] = segmentBegin(g);
+            length[lane] = segmentBegin(g + 1) - begin[lane];
+            for (int r = 0; r < K; r++) state[r][lane] = starts[g][r];
+        }
+        long long common = *std::min_element(length, length + kScanLanes);
+        // Each tile's states go back to series order one lane at a time
+        auto writeTile = [&](long long t0, int count, const double (*states)[K][kScanLanes]) {
+            for (int lane = 0; lane < kScanLanes; lane++) {
+                for (int t = 0; t < count; t++) {
+                    double s[K];
+                    for (int r = 0; r < K; r++) s[r] = states[t][r][lane];
+                    project(s, begin[lane] + t0 + t);
+                }
+            }
+        };
+        advanceScanLanes<K, true>(system, x.data(), begin, common, state, writeTile);
+        for (int lane = 0; lane < kScanLanes; lane++) {
+            double s[K];
+            for (int r = 0; r < K; r++) s[r] = state[r][lane];
+            for (long long t = common; t < length[lane]; t++) {
+                step(s, x[begin[lane] + t]);
+                project(s, begin[lane] + t);
+            }
+        }
+    }
+
+    return outputs;
+}
+
+// Smoothing factor of an N-period EMA
+inline double emaAlpha(int period) {
+    return 2.0 / (period + 1.0);
+}
+
+// Cascade of `depth` EMAs with the same period: state r is the (r+1)-fold EMA of x.
+// e_r[i] = a e_r[i-1] + alpha e_{r-1}[i], expanded so every row only uses s[i-1] and x[i].
+template <int K>
+LinearRecurrence<K> makeEMACascade(int period) {
+    double alpha = emaAlpha(period), a = 1.0 - alpha;
+    LinearRecurrence<K> system = {};
+    for (int r = 0; r < K; r++) {
+        // row r = a * s_r + alpha * row(r-1)
+        for (int c = 0; c < K; c++) system.transition[r][c] = (r > 0) ? alpha * system.transition[r - 1][c] : 0.0;
+        system.transition[r][r] += a;
+        system.input[r] = (r > 0) ? alpha * system.input[r - 1] : alpha;
+    }
+    return system;
+}
+
+// Exponential Moving Average (EMA), seeded with the first price
+std::vector<double> calculateEMA_Scan(const std::vector<double>& prices, int period, int numThreads) {
+    if (prices.empty()) return {};
+    LinearRecurrence<1> system = makeEMACascade<1>(period);
+    return std::move(scanLinearRecurrence_Parallel<1>(system, prices, {prices[0]}, {{1.0}}, numThreads)[0]);
+}
+
+// Double EMA: 2 EMA - EMA(EMA)
+std::vector<double> calculateDEMA_Scan(const std::vector<double>& prices, int period, int numThreads) {
+    if (prices.empty()) return {};
+    LinearRecurrence<2> system = makeEMACascade<2>(period);
+    return std::move(scanLinearRecurrence_Parallel<2>(system, prices, {prices[0], prices[0]}, {{2.0, -1.0}}, numThreads)[0]);
+}
+
+// Triple EMA: 3 EMA - 3 EMA(EMA) + EMA(EMA(EMA))
+std::vector<double> calculateTEMA_Scan(const std::vector<double>& prices, int period, int numThreads) {
+    if (prices.empty()) return {};
+    LinearRecurrence<3> system = makeEMACascade<3>(period);
+    return std::move(scanLinearRecurrence_Parallel<3>(system, prices, {prices[0], prices[0], prices[0]},
+                                                      {{3.0, -3.0, 1.0}}, numThreads)[0]);
+}
+
+struct MACDResult {
+    std::vector<double> macd;      // EMA(fast) - EMA(slow)
+    std::vector<double> signal;    // EMA(signalPeriod) of the MACD line
+    std::vector<double> histogram; // macd - signal
+};
+
+// MACD as one 3-state system: s = (EMA fast, EMA slow, signal)
+MACDResult calculateMACD_Scan(const std::vector<double>& prices, int fast, int slow, int signalPeriod, int numThreads) {
+    MACDResult result;
+    if (prices.empty()) return result;
+    double af = emaAlpha(fast), as = emaAlpha(slow), ag = emaAlpha(signalPeriod);
+    LinearRecurrence<3> system = {};
+    system.transition[0][0] = 1.0 - af;
+    system.transition[1][1] = 1.0 - as;
+    // signal[i] = (1 - ag) signal[i-1] + ag (fast[i] - slow[i])
+    system.transition[2][0] = ag * (1.0 - af);
+    system.transition[2][1] = -ag * (1.0 - as);
+    system.transition[2][2] = 1.0 - ag;
+    system.input[0] = af;
+    system.input[1] = as;
+    system.input[2] = ag * (af - as);
+
+    auto outputs = scanLinearRecurrence_Parallel<3>(system, prices, {prices[0], prices[0], 0.0},
+                                                    {{1.0, -1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, -1.0, -1.0}},
+                                                    numThreads);
+    result.macd = std::move(outputs[0]);
+    result.signal = std::move(outputs[1]);
+    result.histogram = std::move(outputs[2]);
+    return result;
+}
+
+// Reference EMA: the plain sequential recurrence
+std::vector<double> calculateEMA_Sequential(const std::vector<double>& values, int period, double seed) {
+    std::vector<double> ema(values.size());
+    double alpha = emaAlpha(period), state = seed;
+    for (size_t i = 0; i < values.size(); i++) {
+        state = (1.0 - alpha) * state + alpha * values[i];
+        ema[i] = state;
+    }
+    return ema;
+}
+
+// ============ Batched multi-window indicators ============
+
+enum class IndicatorType { SMA, WMA };
+
+struct IndicatorSpec {
+    IndicatorType type;
+    int window;
+};
+
+// One row per IndicatorSpec, each row a full-length series (row-major, contiguous)
+struct IndicatorMatrix {
+    size_t series = 0;
+    size_t length = 0;
+    std::vector<double> values;
+
+    IndicatorMatrix() = default;
+    IndicatorMatrix(size_t seriesCount, size_t n) : series(seriesCount), length(n), values(seriesCount * n, 0.0) {}
+
+    double* row(size_t k) { return values.data() + k * length; }
+    const double* row(size_t k) const { return values.data() + k * length; }
+};
+
+// Error-free sum: s + t == a + b exactly
+inline void twoSum(double a, double b, double& s, double& t) {
+    s = a + b;
+    double bb = s - a;
+    t = (a - (s - bb)) + (b - bb);
+}
+
+// Veltkamp split: hi keeps the top 26 bits, so hi times any integer below 2^26 is exact
+inline void splitHalves(double a, double& hi, double& lo) {
+    double t = 134217729.0 * a;
+    hi = t - (t - a);
+    lo = a - hi;
+}
+
+constexpr size_t kIndicatorBlock = 2048;
+
+// Block kernel shared by the batched and fused paths. The series is cut into blocks;
+// for every block a thread builds compensated prefix sums of x and of (local index) * x
+// over the block plus the largest window before it, and every spec reads its values
+// from those two arrays in O(1). The WMA numerator Q - c P cancels heavily, so ranges
+// and the final difference are carried as (hi, lo) pairs; local indices stay below
+// 2^26, so the products with them are made exact by splitting the other factor.
+// consume(k, blockBegin, blockEnd, values) receives spec k on [blockBegin, blockEnd)
+// in a per-thread, cache-resident buffer (values[i - blockBegin]); entries before the
+// window is full are 0, as in calculateSMA_Parallel. It runs inside the parallel region.
+template <typename Consumer>
+void forEachIndicatorBlock(const std::vector<double>& prices, const std::vector<IndicatorSpec>& specs,
+                           int numThreads, Consumer&& consume) {
+    size_t n = prices.size();
+    if (n == 0 || specs.empty()) return;
+
+    size_t maxWindow = 1;
+    for (const IndicatorSpec& spec : specs) maxWindow = std::max<size_t>(maxWindow, spec.window);
+    // Rebuilding the maxWindow history costs at most as much as the block itself
+    size_t block = std::max(kIndicatorBlock, maxWindow);
+    long long blocks = (n + block - 1) / block;
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+        std::vector<double> sumHi(block + maxWindow + 1), sumLo(block + maxWindow + 1);
+        std::vector<double> weightedHi(block + maxWindow + 1), weightedLo(block + maxWindow + 1);
+        std::vector<double> values(block);
+
+        #pragma omp for schedule(static)
+        for (long long b = 0; b < blocks; b++) {
+            size_t blockBegin = b * block, blockEnd = std::min(n, blockBegin + block);
+            size_t origin = blockBegin > maxWindow ? blockBegin - maxWindow : 0;
+
+            // Local prefix k covers prices[origin, origin + k)
+            double s = 0.0, se = 0.0, q = 0.0, qe = 0.0;
+            sumHi[0] = sumLo[0] = weightedHi[0] = weightedLo[0] = 0.0;
+            for (size_t j = origin; j < blockEnd; j++) {
+                double weight = double(j - origin);
+                double xHi, xLo;
+                splitHalves(prices[j], xHi, xLo);
+                compensatedAdd(s, se, prices[j]);
+                compensatedAdd(q, qe, weight * xHi);
+                qe += weight * xLo;
+                size_t k = j - origin + 1;
+                sumHi[k] = s; sumLo[k] = se;
+                weightedHi[k] = q; weightedLo[k] = qe;
+            }
+
+            for (size_t k = 0; k < specs.size(); k++) {
+                size_t w = specs[k].window;
+                size_t first = std::max(blockBegin, w - 1);
+                for (size_t i = blockBegin; i < std::min(first, blockEnd); i++) values[i - blockBegin] = 0.0;
+
+                // values[hi - 1 + origin - blockBegin] is the output at i = hi - 1 + origin
+                double* local = values.data() + origin - 1 - blockBegin;
+                // Local (int) indices: packed int -> double conversion needs no AVX-512
+                int window = w, hiBegin = first + 1 - origin, hiEnd = blockEnd + 1 - origin;
+                if (specs[k].type == IndicatorType::SMA) {
+                    double scale = 1.0 / w;
+                    #pragma omp simd
+                    for (int hi = hiBegin; hi < hiEnd; hi++) {
+                        int lo = hi - window;
+                        local[hi] = ((sumHi[hi] - sumHi[lo]) + (sumLo[hi] - sumLo[lo])) * scale;
+                    }
+                } else {
+                    double scale = 2.0 / (double(w) * (w + 1));
+                    #pragma omp simd
+                    for (int hi = hiBegin; hi < hiEnd; hi++) {
+                        int lo = hi - window;
+                        // sum (j - (i - w)) x_j = Q - c P with c = i - w - origin
+                        double pHi, pLo, qHi, qLo;
+                        twoSum(sumHi[hi], -sumHi[lo], pHi, pLo);
+                        pLo += sumLo[hi] - sumLo[lo];
+                        twoSum(weightedHi[hi], -weightedHi[lo], qHi, qLo);
+                        qLo += weightedLo[hi] - weightedLo[lo];
+                        double c = double(lo) - 1.0;
+                        double pTop, pBottom, dHi, dLo, eHi, eLo;
+                        splitHalves(pHi, pTop, pBottom);
+                        twoSum(qHi, -c * pTop, dHi, dLo);
+                        twoSum(dHi, -c * pBottom, eHi, eLo);
+                        local[hi] = (eHi + (dLo + eLo + qLo - c * pLo)) * scale;
+                    }
+                }
+                consume(k, blockBegin, blockEnd, static_cast<const double*>(values.data()));
+            }
+        }
+    }
+}
+
+// All specs in one pass over the data into one matrix (see forEachIndicatorBlock).
+// `out` is reused when it already has the right shape.
+void calculateIndicators_Batched(const std::vector<double>& prices, const std::vector<IndicatorSpec>& specs,
+                                 int numThreads, IndicatorMatrix& out) {
+    if (out.series != specs.size() || out.length != prices.size()) out = IndicatorMatrix(specs.size(), prices.size());
+    forEachIndicatorBlock(prices, specs, numThreads, [&](size_t k, size_t blockBegin, size_t blockEnd, const double* values) {
+        std::copy(values, values + (blockEnd - blockBegin), out.row(k) + blockBegin);
+    });
+}
+
+// Synthetic price history (geometric random walk) for benchmarks longer than the CSV
+std::vector<double> generateSyntheticPrices(size_t n, double startPrice, unsigned int seed) {
+    std::vector<double> prices(n);
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.01);
+    double price = startPrice;
+    for (size_t i = 0; i < n; i++) {
+        price *= std::exp(step(rng));
+        prices[i] = price;
+    }
+    return prices;
+}
+
 // Predict the next value (using the last MA value)
 double predictNext(const std::vector<double>& ma, int lastValidIndex) {
     return ma[lastValidIndex];
@@ -101,7 +1057,7 @@ struct ErrorMetrics {
     double mape; // Mean Absolute Percentage Error
 };
 
-ErrorMetrics calculateErrors(const std::vector<double>& actual, const std::vector<double>& predicted, int windowSize) {
+ErrorMetrics calculateErrors(const std::vector<double>& actual, const double* predicted, int windowSize) {
     ErrorMetrics errors = {0, 0, 0, 0};
     int count = 0;
 
@@ -125,6 +1081,112 @@ ErrorMetrics calculateErrors(const std::vector<double>& actual, const std::vecto
     return errors;
 }
 
+ErrorMetrics calculateErrors(const std::vector<double>& actual, const std::vector<double>& predicted, int windowSize) {
+    return calculateErrors(actual, predicted.data(), windowSize);
+}
+
+// Forecast errors of every spec without materialising a single moving average: each
+// block of values is scored while it is still in cache, into per-thread partial sums
+// that are reduced at the end. Same definition as calculateErrors (value i predicts
+// price i + 1, non-positive predictions are skipped); only the summation order differs.
+std::vector<ErrorMetrics> evaluateIndicators_Fused(const std::vector<double>& prices,
+                                                   const std::vector<IndicatorSpec>& specs, int numThreads) {
+    struct Partial {
+        double mae = 0, mse = 0, mape = 0;
+        long long count = 0;
+    };
+    size_t n = prices.size();
+    std::vector<Partial> partials(size_t(std::max(1, numThreads)) * specs.size());
+
+    forEachIndicatorBlock(prices, specs, numThreads, [&](size_t k, size_t blockBegin, size_t blockEnd, const double* values) {
+        size_t begin = std::max<size_t>(blockBegin, specs[k].window - 1), end = std::min(blockEnd, n - 1);
+        double mae = 0, mse = 0, mape = 0;
+        long long count = 0;
+        #pragma omp simd reduction(+: mae, mse, mape, count)
+        for (size_t i = begin; i < end; i++) {
+            double predicted = values[i - blockBegin];
+            double diff = prices[i + 1] - predicted;
+            bool valid = predicted > 0;
+            mae += valid ? std::abs(diff) : 0.0;
+            mse += valid ? diff * diff : 0.0;
+            mape += valid ? std::abs(diff / prices[i + 1]) * 100 : 0.0;
+            count += valid;
+        }
+        Partial& partial = partials[omp_get_thread_num() * specs.size() + k];
+        partial.mae += mae;
+        partial.mse += mse;
+        partial.mape += mape;
+        partial.count += count;
+    });
+
+    std::vector<ErrorMetrics> metrics(specs.size(), ErrorMetrics{0, 0, 0, 0});
+    for (size_t k = 0; k < specs.size(); k++) {
+        Partial total;
+        for (size_t t = k; t < partials.size(); t += specs.size()) {
+            total.mae += partials[t].mae;
+            total.mse += partials[t].mse;
+            total.mape += partials[t].mape;
+            total.count += partials[t].count;
+        }
+        if (total.count > 0) {
+            metrics[k].mae = total.mae / total.count;
+            metrics[k].mse = total.mse / total.count;
+            metrics[k].rmse = std::sqrt(metrics[k].mse);
+            metrics[k].mape = total.mape / total.count;
+        }
+    }
+    return metrics;
+}
+
+// Error curve of every SMA and WMA window 1..maxWindow, with the best window per metric
+struct WindowSearchResult {
+    struct Best {
+        int mae = 0, rmse = 0, mape = 0;
+    };
+    std::vector<int> windows;
+    std::vector<ErrorMetrics> sma; // sma[k] belongs to windows[k]
+    std::vector<ErrorMetrics> wma;
+    Best bestSMA, bestWMA;
+};
+
+// Exhaustive search: all 2 * maxWindow series go through evaluateIndicators_Fused as one
+// spec list, so every block of prices and its prefix sums is loaded once and reused by
+// every window while it is in cache. Windows that leave no forecast are not searched.
+WindowSearchResult searchBestWindows(const std::vector<double>& prices, int maxWindow, int numThreads) {
+    WindowSearchResult result;
+    maxWindow = std::min<long long>(maxWindow, (long long)prices.size() - 1);
+    if (maxWindow < 1) return result;
+
+    std::vector<IndicatorSpec> specs;
+    for (int window = 1; window <= maxWindow; window++) {
+        result.windows.push_back(window);
+        specs.push_back({IndicatorType::SMA, window});
+        specs.push_back({IndicatorType::WMA, window});
+    }
+    std::vector<ErrorMetrics> metrics = evaluateIndicators_Fused(prices, specs, numThreads);
+
+    auto pickBest = [&](const std::vector<ErrorMetrics>& curve) {
+        WindowSearchResult::Best best;
+        size_t mae = 0, rmse = 0, mape = 0;
+        for (size_t k = 1; k < curve.size(); k++) {
+            if (curve[k].mae < curve[mae].mae) mae = k;
+            if (curve[k].rmse < curve[rmse].rmse) rmse = k;
+            if (curve[k].mape < curve[mape].mape) mape = k;
+        }
+        best.mae = result.windows[mae];
+        best.rmse = result.windows[rmse];
+        best.mape = result.windows[mape];
+        return best;
+    };
+    for (int k = 0; k < maxWindow; k++) {
+        result.sma.push_back(metrics[2 * k]);
+        result.wma.push_back(metrics[2 * k + 1]);
+    }
+    result.bestSMA = pickBest(result.sma);
+    result.bestWMA = pickBest(result.wma);
+    return result;
+}
+
 // Measure execution time
 double measureTime(const std::vector<double>& prices, int windowSize, int numThreads, bool useWMA) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -140,25 +1202,571 @@ double measureTime(const std::vector<double>& prices, int windowSize, int numThr
     return duration.count();
 }
 
-int main() {
-    std::cout << "=== Intel (INTC) Stock Price Prediction using OpenMP ===" << std::endl;
-    std::cout << std::endl;
+// ============ Multi-ticker analytics ============
 
-    // Read data
-    std::vector<StockData> data = readCSV("INTC.csv");
-    std::cout << "Loaded " << data.size() << " records" << std::endl;
+// Per-ticker CSVs: every *.csv in a directory, or a manifest with one path per line
+// (relative paths are taken from the manifest's directory; blank and # lines are skipped)
+std::vector<std::string> collectTickerFiles(const std::string& path) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (entry.is_regular_file(ec) && entry.path().extension() == ".csv") files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+    std::ifstream manifest(path);
+    fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        fs::path file(line);
+        files.push_back(file.is_absolute() ? file.string() : (base / file).string());
+    }
+    return files;
+}
 
-    // Extract closing prices
-    std::vector<double> prices;
-    for (const auto& d : data) {
-        prices.push_back(d.close);
+// One deque per worker: the owner pops from the back, idle workers steal from the front
+// of someone else's. Tasks never spawn tasks, so a worker that finds every deque empty
+// is done. Returns the number of steals.
+size_t runWorkStealing(size_t taskCount, int numWorkers, const std::function<void(size_t)>& task) {
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+    numWorkers = std::max(1, numWorkers);
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (int w = 0; w < numWorkers; w++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+        // Contiguous ranges: uneven histories leave some owners with more work than others
+        for (size_t t = taskCount * w / numWorkers; t < taskCount * (w + 1) / numWorkers; t++) {
+            queues[w]->tasks.push_back(t);
+        }
     }
+    std::atomic<size_t> steals(0);
 
-    // Window sizes: day (1), week (5), month (21 trading days)
+    auto worker = [&](int self) {
+        while (true) {
+            size_t next = 0;
+            bool found = false;
+            {
+                std::lock_guard<std::mutex> guard(queues[self]->lock);
+                if (!queues[self]->tasks.empty()) {
+                    next = queues[self]->tasks.back();
+                    queues[self]->tasks.pop_back();
+                    found = true;
+                }
+            }
+            for (int offset = 1; !found && offset < numWorkers; offset++) {
+                WorkQueue& victim = *queues[(self + offset) % numWorkers];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    next = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    found = true;
+                    steals++;
+                }
+            }
+            if (!found) return;
+            task(next);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < numWorkers; w++) threads.emplace_back(worker, w);
+    worker(0);
+    for (std::thread& thread : threads) thread.join();
+    return steals;
+}
+
+struct TickerResult {
+    std::string ticker;
+    size_t rows = 0;
+    bool ok = false;
+    std::vector<ErrorMetrics> sma; // one per window
+    std::vector<ErrorMetrics> wma;
+    // Exhaustive search (only with --max-window): best MAPE window and its MAPE
+    int optimalSMA = 0, optimalWMA = 0;
+    double optimalSMA_MAPE = 0, optimalWMA_MAPE = 0;
+};
+
+// Load one ticker and score every SMA/WMA forecast in one fused pass.
+// Runs on a pool worker, so everything inside is single-threaded.
+TickerResult analyseTicker(const std::string& file, const std::vector<int>& windowSizes, int searchWindow) {
+    TickerResult result;
+    result.ticker = std::filesystem::path(file).stem().string();
+    StockColumns columns = readCSV_Mapped(file, 1);
+    result.rows = columns.size();
+    if (result.rows < 2) return result;
+
+    std::vector<IndicatorSpec> specs;
+    for (int windowSize : windowSizes) {
+        specs.push_back({IndicatorType::SMA, windowSize});
+        specs.push_back({IndicatorType::WMA, windowSize});
+    }
+    std::vector<ErrorMetrics> metrics = evaluateIndicators_Fused(columns.close, specs, 1);
+    for (size_t k = 0; k < windowSizes.size(); k++) {
+        result.sma.push_back(metrics[2 * k]);
+        result.wma.push_back(metrics[2 * k + 1]);
+    }
+    if (searchWindow > 0) {
+        WindowSearchResult search = searchBestWindows(columns.close, searchWindow, 1);
+        result.optimalSMA = search.bestSMA.mape;
+        result.optimalWMA = search.bestWMA.mape;
+        result.optimalSMA_MAPE = search.sma[search.bestSMA.mape - 1].mape;
+        result.optimalWMA_MAPE = search.wma[search.bestWMA.mape - 1].mape;
+    }
+    result.ok = true;
+    return result;
+}
+
+// `lab3 --tickers <dir|manifest> [--max-window N]`: the whole universe on 1..maxThreads
+// workers, then a summary of which window forecasts best across tickers; with
+// --max-window every ticker also gets an exhaustive search over windows 1..N
+int runTickerUniverse(const std::string& path, int maxThreads, int searchWindow) {
+    std::vector<std::string> files = collectTickerFiles(path);
+    if (files.empty()) {
+        std::cerr << "No ticker CSVs found in " << path << std::endl;
+        return 1;
+    }
     std::vector<int> windowSizes = {5, 10, 21, 50, 100, 200};
+    std::vector<TickerResult> results(files.size());
+
+    std::cout << "=== MULTI-TICKER SCALING (" << files.size() << " tickers) ===" << std::endl;
+    std::cout << std::setw(10) << "Threads"
+              << std::setw(15) << "Time (ms)"
+              << std::setw(15) << "Tickers/s"
+              << std::setw(12) << "Speedup"
+              << std::setw(10) << "Steals" << std::endl;
+    std::cout << std::string(62, '-') << std::endl;
+    double baseMs = 0;
+    for (int threads = 1; threads <= maxThreads;
+         threads = (threads == maxThreads) ? maxThreads + 1 : std::min(threads * 2, maxThreads)) {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t steals = runWorkStealing(files.size(), threads, [&](size_t t) {
+            results[t] = analyseTicker(files[t], windowSizes, searchWindow);
+        });
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (threads == 1) baseMs = ms;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(10) << threads
+                  << std::setw(15) << ms
+                  << std::setw(15) << (files.size() / (ms / 1000.0))
+                  << std::setw(12) << (baseMs / ms)
+                  << std::setw(10) << steals << std::endl;
+    }
+    std::cout << std::endl;
+
+    // Aggregate: mean MAPE per window and how often each window is a ticker's best.
+    // A window that is not shorter than a history produces no forecast for it.
+    struct WindowSummary {
+        int scored = 0;
+        double smaMape = 0, wmaMape = 0;
+        int smaBest = 0, wmaBest = 0;
+    };
+    size_t loaded = 0, totalRows = 0;
+    std::vector<WindowSummary> summary(windowSizes.size());
+    for (const TickerResult& result : results) {
+        if (!result.ok) continue;
+        loaded++;
+        totalRows += result.rows;
+        size_t none = windowSizes.size(), bestSMA = none, bestWMA = none;
+        for (size_t k = 0; k < windowSizes.size(); k++) {
+            if (size_t(windowSizes[k]) >= result.rows) continue;
+            summary[k].scored++;
+            summary[k].smaMape += result.sma[k].mape;
+            summary[k].wmaMape += result.wma[k].mape;
+            if (bestSMA == none || result.sma[k].mape < result.sma[bestSMA].mape) bestSMA = k;
+            if (bestWMA == none || result.wma[k].mape < result.wma[bestWMA].mape) bestWMA = k;
+        }
+        if (bestSMA != none) summary[bestSMA].smaBest++;
+        if (bestWMA != none) summary[bestWMA].wmaBest++;
+    }
+
+    std::cout << "=== UNIVERSE SUMMARY ===" << std::endl;
+    std::cout << "Tickers analysed: " << loaded << " of " << files.size()
+              << ", rows: " << totalRows << std::endl;
+    for (const TickerResult& result : results) {
+        if (!result.ok) std::cout << "Skipped " << result.ticker << " (no usable records)" << std::endl;
+    }
+    if (loaded == 0) return 1;
+    std::cout << std::setw(10) << "Window"
+              << std::setw(10) << "Tickers"
+              << std::setw(18) << "Mean SMA MAPE%"
+              << std::setw(12) << "SMA best"
+              << std::setw(18) << "Mean WMA MAPE%"
+              << std::setw(12) << "WMA best" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    for (size_t k = 0; k < windowSizes.size(); k++) {
+        const WindowSummary& row = summary[k];
+        std::cout << std::setprecision(6)
+                  << std::setw(10) << windowSizes[k]
+                  << std::setw(10) << row.scored
+                  << std::setw(18) << (row.scored ? row.smaMape / row.scored : 0.0)
+                  << std::setw(12) << row.smaBest
+                  << std::setw(18) << (row.scored ? row.wmaMape / row.scored : 0.0)
+                  << std::setw(12) << row.wmaBest << std::endl;
+    }
+
+    if (searchWindow > 0) {
+        // Distribution of the per-ticker optimum over 1..searchWindow
+        std::vector<int> smaOptimal, wmaOptimal;
+        double smaMape = 0, wmaMape = 0;
+        for (const TickerResult& result : results) {
+            if (!result.ok || result.optimalSMA == 0) continue;
+            smaOptimal.push_back(result.optimalSMA);
+            wmaOptimal.push_back(result.optimalWMA);
+            smaMape += result.optimalSMA_MAPE;
+            wmaMape += result.optimalWMA_MAPE;
+        }
+        if (!smaOptimal.empty()) {
+            std::sort(smaOptimal.begin(), smaOptimal.end());
+            std::sort(wmaOptimal.begin(), wmaOptimal.end());
+            size_t count = smaOptimal.size();
+            std::cout << std::endl;
+            std::cout << "=== OPTIMAL WINDOW PER TICKER (1.." << searchWindow << ", by MAPE) ===" << std::endl;
+            std::cout << std::setw(10) << "MA"
+                      << std::setw(10) << "Min"
+                      << std::setw(10) << "Median"
+                      << std::setw(10) << "Max"
+                      << std::setw(18) << "Mean best MAPE%" << std::endl;
+            std::cout << std::string(58, '-') << std::endl;
+            std::cout << std::setw(10) << "SMA"
+                      << std::setw(10) << smaOptimal.front()
+                      << std::setw(10) << smaOptimal[count / 2]
+                      << std::setw(10) << smaOptimal.back()
+                      << std::setw(18) << smaMape / count << std::endl;
+            std::cout << std::setw(10) << "WMA"
+                      << std::setw(10) << wmaOptimal.front()
+                      << std::setw(10) << wmaOptimal[count / 2]
+                      << std::setw(10) << wmaOptimal.back()
+                      << std::setw(18) << wmaMape / count << std::endl;
+        }
+    }
+    return 0;
+}
+
+// ============ Streaming indicators ============
+
+// Incremental SMA/WMA/EMA for one ticker: a ring buffer of the last maxWindow closes,
+// compensated running sums per window and one EMA state per period. Every update is
+// O(number of windows), independent of the window lengths and of the history.
+// Running sums keep the rounding residue of every value they have seen, which ruins
+// them once prices move by orders of magnitude; so each window also rebuilds a shadow
+// copy from scratch over the next w bars and swaps it in, one term per bar.
+class StreamingIndicators {
+public:
+    explicit StreamingIndicators(const std::vector<int>& windows)
+        : windows(windows), state(windows.size()) {
+        int maxWindow = 1;
+        for (int w : windows) maxWindow = std::max(maxWindow, w);
+        ring.assign(maxWindow, 0.0);
+    }
+
+    void update(double close) {
+        size_t capacity = ring.size();
+        for (size_t k = 0; k < windows.size(); k++) {
+            WindowState& s = state[k];
+            int w = windows[k];
+            if (bars == 0) s.ema = close;
+            else s.ema += emaAlpha(w) * (close - s.ema);
+
+            if (bars < size_t(w)) {
+                // Warm-up: weights 1..bars+1, the newest bar has the largest
+                compensatedAdd(s.weighted, s.weightedError, (bars + 1) * close);
+                compensatedAdd(s.sum, s.sumError, close);
+            } else {
+                // N[i] = N[i-1] + w x[i] - S[i-1];  S[i] = S[i-1] + x[i] - x[i-w]
+                double leaving = ring[(bars - w) % capacity];
+                compensatedAdd(s.weighted, s.weightedError, w * close);
+                compensatedAdd(s.weighted, s.weightedError, -(s.sum + s.sumError));
+                compensatedAdd(s.sum, s.sumError, close);
+                compensatedAdd(s.sum, s.sumError, -leaving);
+            }
 
+            compensatedAdd(s.shadowWeighted, s.shadowWeightedError, (s.shadowBars + 1) * close);
+            compensatedAdd(s.shadowSum, s.shadowSumError, close);
+            if (++s.shadowBars == w) {
+                s.sum = s.shadowSum;
+                s.sumError = s.shadowSumError;
+                s.weighted = s.shadowWeighted;
+                s.weightedError = s.shadowWeightedError;
+                s.shadowSum = s.shadowSumError = s.shadowWeighted = s.shadowWeightedError = 0;
+                s.shadowBars = 0;
+            }
+        }
+        ring[bars % capacity] = close;
+        bars++;
+    }
+
+    size_t count() const { return bars; }
+    bool ready(size_t k) const { return bars >= size_t(windows[k]); }
+    double sma(size_t k) const { return (state[k].sum + state[k].sumError) / windows[k]; }
+    double wma(size_t k) const {
+        double w = windows[k];
+        return (state[k].weighted + state[k].weightedError) / (w * (w + 1) / 2.0);
+    }
+    double ema(size_t k) const { return state[k].ema; }
+
+private:
+    struct WindowState {
+        double sum = 0, sumError = 0;
+        double weighted = 0, weightedError = 0;
+        double ema = 0;
+        // Fresh sums over the bars since the last swap
+        double shadowSum = 0, shadowSumError = 0;
+        double shadowWeighted = 0, shadowWeightedError = 0;
+        int shadowBars = 0;
+    };
+
+    std::vector<int> windows;
+    std::vector<WindowState> state;
+    std::vector<double> ring;
+    size_t bars = 0;
+};
+
+// Latencies in nanoseconds as a log-bucket histogram: 16 buckets per power of two keep a
+// percentile within ~6% of the exact value, and memory stays fixed however long a stream runs
+struct LatencyRecorder {
+    static constexpr int kSubBuckets = 16;
+    static constexpr int kOctaves = 48;
+    std::array<uint64_t, kOctaves * kSubBuckets> buckets = {};
+    uint64_t count = 0;
+    double maxSample = 0;
+
+    void record(double ns) {
+        int index = 0;
+        if (ns >= 1.0) {
+            int exponent;
+            double fraction = std::frexp(ns, &exponent); // ns = fraction * 2^exponent, fraction in [0.5, 1)
+            index = std::min((exponent - 1) * kSubBuckets + int((2.0 * fraction - 1.0) * kSubBuckets),
+                             kOctaves * kSubBuckets - 1);
+        }
+        buckets[index]++;
+        count++;
+        maxSample = std::max(maxSample, ns);
+    }
+
+    // Upper edge of the bucket holding the sample of rank floor(p% * count), capped at the max
+    double percentile(double p) const {
+        uint64_t rank = std::min<uint64_t>(count - 1, uint64_t(p / 100.0 * count));
+        uint64_t seen = 0;
+        for (int index = 0; index < int(buckets.size()); index++) {
+            seen += buckets[index];
+            if (seen > rank) {
+                double edge = std::ldexp(1.0 + double(index % kSubBuckets + 1) / kSubBuckets, index / kSubBuckets);
+                return std::min(edge, maxSample);
+            }
+        }
+        return maxSample;
+    }
+
+    void print(std::ostream& out, const char* label) const {
+        if (count == 0) return;
+        out << std::fixed << std::setprecision(0)
+            << std::setw(18) << label
+            << std::setw(10) << count
+            << std::setw(10) << percentile(50)
+            << std::setw(10) << percentile(90)
+            << std::setw(10) << percentile(99)
+            << std::setw(10) << percentile(99.9)
+            << std::setw(10) << maxSample << std::endl;
+    }
+
+    static void printHeader(std::ostream& out) {
+        out << std::setw(18) << "Latency (ns)"
+            << std::setw(10) << "Bars"
+            << std::setw(10) << "p50"
+            << std::setw(10) << "p90"
+            << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9"
+            << std::setw(10) << "max" << std::endl;
+        out << std::string(78, '-') << std::endl;
+    }
+};
+
+// Streaming mode stops on SIGINT/SIGTERM as well as at the end of stdin
+volatile std::sig_atomic_t streamStopRequested = 0;
+
+// `lab3 --stream <file|->`: consume bars as they are appended and print the updated
+// indicators as CSV on stdout. Lines are "Date,Open,High,Low,Close,Adj Close,Volume",
+// optionally prefixed by a ticker column; headers and malformed lines are skipped.
+// A file is followed like `tail -f` until the process is interrupted; latency
+// percentiles go to stderr at the end.
+int runStreaming(const std::string& source) {
+    const std::vector<int> windows = {5, 10, 21, 50, 100, 200};
+    const int followPollMs = 50;
+
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source);
+        if (!file) {
+            std::cerr << "Cannot open " << source << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = (source == "-") ? std::cin : file;
+    // No SA_RESTART: a signal must interrupt a getline blocked on an idle pipe, not resume it
+    struct sigaction stopAction = {};
+    stopAction.sa_handler = [](int) { streamStopRequested = 1; };
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, nullptr);
+    sigaction(SIGTERM, &stopAction, nullptr);
+
+    std::cout << "ticker,date,close";
+    for (int w : windows) std::cout << ",sma" << w << ",wma" << w << ",ema" << w;
+    std::cout << '\n';
+
+    std::unordered_map<std::string, StreamingIndicators> tickers;
+    StockColumns bar;
+    bar.resize(1);
+    LatencyRecorder updateLatency, barLatency;
+    std::string line, pending;
+    char buffer[64];
+
+    while (!streamStopRequested) {
+        if (!std::getline(in, line)) {
+            if (source == "-" || in.bad() || streamStopRequested) break;
+            in.clear();
+            std::cout.flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(followPollMs));
+            continue;
+        }
+        if (in.eof() && source != "-") {
+            // Growing file: the writer is mid-line, keep the part read so far
+            pending += line;
+            in.clear();
+            std::cout.flush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(followPollMs));
+            continue;
+        }
+        if (!pending.empty()) {
+            line = pending + line;
+            pending.clear();
+        }
+
+        auto barStart = std::chrono::steady_clock::now();
+        size_t commas = std::count(line.begin(), line.end(), ',');
+        std::string ticker = "-";
+        const char* begin = line.data();
+        if (commas == 7) {
+            size_t cut = line.find(',');
+            ticker = line.substr(0, cut);
+            begin += cut + 1;
+        }
+        if (!parseStockLine(begin, line.data() + line.size(), bar, 0)) continue;
+
+        StreamingIndicators& indicators = tickers.try_emplace(ticker, windows).first->second;
+
+        auto updateStart = std::chrono::steady_clock::now();
+        indicators.update(bar.close[0]);
+        auto updateEnd = std::chrono::steady_clock::now();
+
+        std::string out = ticker + ',' + formatDay(bar.day[0]);
+        auto append = [&](double value) {
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out += ',';
+            out.append(buffer, result.ptr);
+        };
+        append(bar.close[0]);
+        for (size_t k = 0; k < windows.size(); k++) {
+            if (indicators.ready(k)) {
+                append(indicators.sma(k));
+                append(indicators.wma(k));
+            } else {
+                out += ",,";
+            }
+            append(indicators.ema(k));
+        }
+        out += '\n';
+        std::cout << out;
+        auto barEnd = std::chrono::steady_clock::now();
+
+        updateLatency.record(std::chrono::duration<double, std::nano>(updateEnd - updateStart).count());
+        barLatency.record(std::chrono::duration<double, std::nano>(barEnd - barStart).count());
+    }
+    std::cout.flush();
+
+    std::cerr << "Streamed " << barLatency.count << " bars for " << tickers.size() << " ticker(s)" << std::endl;
+    LatencyRecorder::printHeader(std::cerr);
+    updateLatency.print(std::cerr, "indicator update");
+    barLatency.print(std::cerr, "parse+update+emit");
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
     // Number of available cores
     int maxThreads = omp_get_max_threads();
+
+    if (argc > 1) {
+        std::string option = argv[1];
+        int searchWindow = 0;
+        if (option == "--tickers" && argc == 5 && std::string(argv[3]) == "--max-window") {
+            searchWindow = std::atoi(argv[4]);
+        }
+        if (option == "--tickers" && (argc == 3 || searchWindow > 0)) {
+            std::cout << "=== Multi-ticker analysis using a work-stealing thread pool ===" << std::endl;
+            std::cout << std::endl;
+            return runTickerUniverse(argv[2], maxThreads, searchWindow);
+        }
+        if (option == "--stream" && argc == 3) {
+            return runStreaming(argv[2]);
+        }
+        std::cerr << "Usage: " << argv[0]
+                  << " [--tickers <directory|manifest> [--max-window N] | --stream <file|->]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== Intel (INTC) Stock Price Prediction using OpenMP ===" << std::endl;
+    std::cout << std::endl;
+
+    // Read data: the column cache when it is current, otherwise the mapped CSV reader
+    // (checked against readCSV), which then writes the cache for the next run
+    const std::string csvFile = "INTC.csv";
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    TimeSeriesTable table = TimeSeriesTable::load(csvFile, maxThreads);
+    auto loadEnd = std::chrono::high_resolution_clock::now();
+    if (table.size() < 2) {
+        std::cerr << "No usable records in " << csvFile << std::endl;
+        return 1;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+    std::ifstream sizeProbe(csvFile, std::ios::binary | std::ios::ate);
+    double csvMB = sizeProbe.tellg() / (1024.0 * 1024.0);
+    std::cout << "Loaded " << table.size() << " records " << std::setprecision(2) << std::fixed;
+    if (table.fromCache()) {
+        std::cout << "from " << csvFile << ".cols (" << loadMs << " ms)" << std::endl;
+    } else {
+        std::cout << "(" << csvMB << " MB in " << loadMs << " ms, " << (csvMB / (loadMs / 1000.0)) << " MB/s)" << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+    if (table.skippedRows() > 0) {
+        // readCSV throws on malformed rows, so there is no reference to compare with
+        std::cout << "Skipped " << table.skippedRows() << " malformed rows" << std::endl;
+    } else if (!table.fromCache()) {
+        std::vector<StockData> data = readCSV(csvFile);
+        bool sameAsReference = data.size() == table.size();
+        for (size_t i = 0; sameAsReference && i < data.size(); i++) {
+            sameAsReference = data[i].date == formatDay(table.day()[i])
+                && data[i].open == table.open()[i] && data[i].high == table.high()[i]
+                && data[i].low == table.low()[i] && data[i].close == table.close()[i]
+                && data[i].adjClose == table.adjClose()[i] && data[i].volume == table.volume()[i];
+        }
+        std::cout << "Mapped reader matches readCSV: " << (sameAsReference ? "yes" : "NO") << std::endl;
+    }
+
+    // Closing prices: the only column the analysis reads
+    std::vector<double> prices = table.priceColumn(TimeSeriesTable::Close);
+
+    // Window sizes: day (1), week (5), month (21 trading days)
+    std::vector<int> windowSizes = {5, 10, 21, 50, 100, 200};
+
     std::cout << "Maximum number of threads: " << maxThreads << std::endl;
     std::cout << std::endl;
 
@@ -176,12 +1784,18 @@ int main() {
     double bestSMA_MAPE = 1e9, bestWMA_MAPE = 1e9;
     int bestSMA_Window = 0, bestWMA_Window = 0;
 
+    // Every SMA and WMA of the table scored in one fused pass: 2k and 2k + 1 for windowSizes[k]
+    std::vector<IndicatorSpec> accuracySpecs;
     for (int windowSize : windowSizes) {
-        std::vector<double> sma = calculateSMA_Parallel(prices, windowSize, maxThreads);
-        std::vector<double> wma = calculateWMA_Parallel(prices, windowSize, maxThreads);
+        accuracySpecs.push_back({IndicatorType::SMA, windowSize});
+        accuracySpecs.push_back({IndicatorType::WMA, windowSize});
+    }
+    std::vector<ErrorMetrics> accuracyMetrics = evaluateIndicators_Fused(prices, accuracySpecs, maxThreads);
 
-        ErrorMetrics smaErrors = calculateErrors(prices, sma, windowSize);
-        ErrorMetrics wmaErrors = calculateErrors(prices, wma, windowSize);
+    for (size_t k = 0; k < windowSizes.size(); k++) {
+        int windowSize = windowSizes[k];
+        ErrorMetrics smaErrors = accuracyMetrics[2 * k];
+        ErrorMetrics wmaErrors = accuracyMetrics[2 * k + 1];
 
         std::cout << std::fixed << std::setprecision(6);
         std::cout << std::setw(10) << windowSize
@@ -221,6 +1835,8 @@ int main() {
     std::cout << "Last known price: " << lastPrice << std::endl;
     std::cout << "SMA Prediction (window=" << predictionWindow << "): " << smaPrediction << std::endl;
     std::cout << "WMA Prediction (window=" << predictionWindow << "): " << wmaPrediction << std::endl;
+    std::vector<double> ema = calculateEMA_Scan(prices, predictionWindow, maxThreads);
+    std::cout << "EMA Prediction (period=" << predictionWindow << "): " << predictNext(ema, prices.size() - 1) << std::endl;
     std::cout << std::endl;
 
     // ============ PART 3: Performance comparison on 1-N cores ============
@@ -287,6 +1903,443 @@ int main() {
                   << std::setw(15) << (totalWMA / numRuns) << std::endl;
     }
 
+    std::cout << std::endl;
+
+    // ============ PART 5: O(n) prefix-sum SMA vs. direct window sums ============
+    const size_t benchLength = 200000;
+    const int benchRuns = 3;
+    std::vector<double> longPrices = generateSyntheticPrices(benchLength, prices.back(), 42);
+    std::vector<int> benchWindows = {5, 10, 21, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+
+    std::cout << "=== PREFIX-SUM SMA vs DIRECT SMA (" << benchLength << " synthetic points, all threads) ===" << std::endl;
+    std::cout << std::setw(10) << "Window"
+              << std::setw(15) << "Direct (ms)"
+              << std::setw(15) << "Prefix (ms)"
+              << std::setw(15) << "Speedup"
+              << std::setw(15) << "Max rel diff" << std::endl;
+    std::cout << std::string(70, '-') << std::endl;
+
+    for (int windowSize : benchWindows) {
+        double totalDirect = 0, totalPrefix = 0;
+        std::vector<double> direct, prefix;
+
+        for (int run = 0; run < benchRuns; run++) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            direct = calculateSMA_Parallel(longPrices, windowSize, maxThreads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            prefix = calculateSMA_PrefixSum(longPrices, windowSize, maxThreads);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            totalDirect += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            totalPrefix += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+
+        double maxDiff = 0.0;
+        for (size_t i = windowSize - 1; i < longPrices.size(); i++) {
+            maxDiff = std::max(maxDiff, std::abs(prefix[i] - direct[i]) / std::abs(direct[i]));
+        }
+
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << std::setw(10) << windowSize
+                  << std::setw(15) << (totalDirect / benchRuns)
+                  << std::setw(15) << (totalPrefix / benchRuns)
+                  << std::setw(15) << (totalDirect / totalPrefix)
+                  << std::setw(15) << std::scientific << std::setprecision(2) << maxDiff << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // ============ PART 6: O(n) recurrence WMA vs. direct weighted sums ============
+    std::cout << std::fixed;
+    std::cout << "=== RECURRENCE WMA vs DIRECT WMA (" << benchLength << " synthetic points, all threads) ===" << std::endl;
+    std::cout << std::setw(10) << "Window"
+              << std::setw(15) << "Direct (ms)"
+              << std::setw(15) << "Recur. (ms)"
+              << std::setw(15) << "Speedup"
+              << std::setw(15) << "Max rel diff" << std::endl;
+    std::cout << std::string(70, '-') << std::endl;
+
+    for (int windowSize : benchWindows) {
+        double totalDirect = 0, totalRecurrence = 0;
+        std::vector<double> direct, recurrence;
+
+        for (int run = 0; run < benchRuns; run++) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            direct = calculateWMA_Parallel(longPrices, windowSize, maxThreads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            recurrence = calculateWMA_Recurrence(longPrices, windowSize, maxThreads);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            totalDirect += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            totalRecurrence += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+
+        double maxDiff = 0.0;
+        for (size_t i = windowSize - 1; i < longPrices.size(); i++) {
+            maxDiff = std::max(maxDiff, std::abs(recurrence[i] - direct[i]) / std::abs(direct[i]));
+        }
+
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << std::setw(10) << windowSize
+                  << std::setw(15) << (totalDirect / benchRuns)
+                  << std::setw(15) << (totalRecurrence / benchRuns)
+                  << std::setw(15) << (totalDirect / totalRecurrence)
+                  << std::setw(15) << std::scientific << std::setprecision(2) << maxDiff << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // ============ PART 7: Exponential indicators via the parallel linear-recurrence scan ============
+    std::cout << std::fixed;
+    std::cout << "=== EXPONENTIAL INDICATORS (scan engine) ===" << std::endl;
+    std::cout << std::setw(10) << "Period"
+              << std::setw(15) << "EMA MAPE%"
+              << std::setw(15) << "DEMA MAPE%"
+              << std::setw(15) << "TEMA MAPE%" << std::endl;
+    std::cout << std::string(55, '-') << std::endl;
+    for (int period : windowSizes) {
+        ErrorMetrics emaErrors = calculateErrors(prices, calculateEMA_Scan(prices, period, maxThreads), period);
+        ErrorMetrics demaErrors = calculateErrors(prices, calculateDEMA_Scan(prices, period, maxThreads), period);
+        ErrorMetrics temaErrors = calculateErrors(prices, calculateTEMA_Scan(prices, period, maxThreads), period);
+        std::cout << std::setprecision(6)
+                  << std::setw(10) << period
+                  << std::setw(15) << emaErrors.mape
+                  << std::setw(15) << demaErrors.mape
+                  << std::setw(15) << temaErrors.mape << std::endl;
+    }
+
+    MACDResult macd = calculateMACD_Scan(prices, 12, 26, 9, maxThreads);
+    std::cout << "MACD(12, 26, 9) last bar: line " << macd.macd.back()
+              << ", signal " << macd.signal.back()
+              << ", histogram " << macd.histogram.back() << std::endl;
+
+    // Scan results against the plain sequential recurrences
+    {
+        int period = 21;
+        std::vector<double> e1 = calculateEMA_Sequential(longPrices, period, longPrices[0]);
+        std::vector<double> e2 = calculateEMA_Sequential(e1, period, longPrices[0]);
+        std::vector<double> e3 = calculateEMA_Sequential(e2, period, longPrices[0]);
+        std::vector<double> fastRef = calculateEMA_Sequential(longPrices, 12, longPrices[0]);
+        std::vector<double> slowRef = calculateEMA_Sequential(longPrices, 26, longPrices[0]);
+        std::vector<double> lineRef(longPrices.size());
+        for (size_t i = 0; i < longPrices.size(); i++) lineRef[i] = fastRef[i] - slowRef[i];
+        std::vector<double> signalRef = calculateEMA_Sequential(lineRef, 9, 0.0);
+
+        std::vector<double> emaScan = calculateEMA_Scan(longPrices, period, maxThreads);
+        std::vector<double> demaScan = calculateDEMA_Scan(longPrices, period, maxThreads);
+        std::vector<double> temaScan = calculateTEMA_Scan(longPrices, period, maxThreads);
+        MACDResult macdScan = calculateMACD_Scan(longPrices, 12, 26, 9, maxThreads);
+
+        double emaDiff = 0, demaDiff = 0, temaDiff = 0, macdDiff = 0;
+        for (size_t i = 0; i < longPrices.size(); i++) {
+            emaDiff = std::max(emaDiff, std::abs(emaScan[i] - e1[i]) / std::abs(e1[i]));
+            demaDiff = std::max(demaDiff, std::abs(demaScan[i] - (2 * e1[i] - e2[i])) / std::abs(e1[i]));
+            temaDiff = std::max(temaDiff, std::abs(temaScan[i] - (3 * e1[i] - 3 * e2[i] + e3[i])) / std::abs(e1[i]));
+            macdDiff = std::max(macdDiff, std::abs(macdScan.signal[i] - signalRef[i]) / std::abs(longPrices[i]));
+        }
+        std::cout << std::scientific << std::setprecision(2)
+                  << "Scan vs sequential (max rel diff): EMA " << emaDiff << ", DEMA " << demaDiff
+                  << ", TEMA " << temaDiff << ", MACD signal " << macdDiff << std::endl;
+        std::cout << std::fixed;
+    }
+
+    // Scaling of the scan over threads on a long synthetic series
+    const size_t scanLength = 5000000;
+    std::vector<double> scanPrices = generateSyntheticPrices(scanLength, prices.back(), 7);
+    std::cout << std::endl;
+    std::cout << "=== EMA / MACD SCAN SCALING (" << scanLength << " synthetic points) ===" << std::endl;
+    auto sequentialStart = std::chrono::high_resolution_clock::now();
+    std::vector<double> sequentialEMA = calculateEMA_Sequential(scanPrices, 21, scanPrices[0]);
+    auto sequentialEnd = std::chrono::high_resolution_clock::now();
+    double sequentialMs = std::chrono::duration<double, std::milli>(sequentialEnd - sequentialStart).count();
+    std::cout << "Sequential EMA (ms): " << std::setprecision(4) << sequentialMs << std::endl;
+    std::cout << std::setw(10) << "Threads"
+              << std::setw(15) << "EMA (ms)"
+              << std::setw(15) << "MACD (ms)"
+              << std::setw(15) << "EMA Speedup" << std::endl;
+    std::cout << std::string(55, '-') << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        double totalEMA = 0, totalMACD = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            std::vector<double> emaRun = calculateEMA_Scan(scanPrices, 21, threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            MACDResult macdRun = calculateMACD_Scan(scanPrices, 12, 26, 9, threads);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            totalEMA += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            totalMACD += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+        std::cout << std::setw(10) << threads
+                  << std::setw(15) << (totalEMA / benchRuns)
+                  << std::setw(15) << (totalMACD / benchRuns)
+                  << std::setw(15) << (sequentialMs / (totalEMA / benchRuns)) << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // ============ PART 8: CSV ingestion throughput ============
+    // The CSV body repeated until the file is big enough for a stable MB/s figure
+    const std::string ingestFile = "lab3_ingest.csv";
+    const int ingestCopies = 64;
+    {
+        std::ifstream source(csvFile, std::ios::binary);
+        std::string header, body;
+        std::getline(source, header);
+        body.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+        if (!body.empty() && body.back() != '\n') body += '\n';
+        std::ofstream target(ingestFile, std::ios::binary);
+        target << header << '\n';
+        for (int copy = 0; copy < ingestCopies; copy++) target << body;
+    }
+    std::ifstream ingestProbe(ingestFile, std::ios::binary | std::ios::ate);
+    double ingestMB = ingestProbe.tellg() / (1024.0 * 1024.0);
+
+    std::cout << "=== CSV INGESTION (" << std::setprecision(1) << ingestMB << " MB, "
+              << ingestCopies << " x " << csvFile << ") ===" << std::endl;
+    std::cout << std::setw(20) << "Reader"
+              << std::setw(10) << "Threads"
+              << std::setw(12) << "Rows"
+              << std::setw(15) << "Time (ms)"
+              << std::setw(12) << "MB/s" << std::endl;
+    std::cout << std::string(69, '-') << std::endl;
+    auto printIngest = [&](const char* reader, int threads, size_t rows, double ms) {
+        std::cout << std::setw(20) << reader
+                  << std::setw(10) << threads
+                  << std::setw(12) << rows
+                  << std::setw(15) << std::setprecision(2) << ms
+                  << std::setw(12) << std::setprecision(1) << (ingestMB / (ms / 1000.0)) << std::endl;
+    };
+    if (table.skippedRows() == 0) {
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t rows = readCSV(ingestFile).size();
+        auto end = std::chrono::high_resolution_clock::now();
+        printIngest("getline + stod", 1, rows, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    for (int threads = 1; threads <= maxThreads;
+         threads = (threads == maxThreads) ? maxThreads + 1 : std::min(threads * 2, maxThreads)) {
+        double totalMs = 0;
+        size_t rows = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            rows = readCSV_Mapped(ingestFile, threads).size();
+            auto end = std::chrono::high_resolution_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        printIngest("mmap + from_chars", threads, rows, totalMs / benchRuns);
+    }
+    // Column cache: the first load parses and writes it, later loads map it and read Close
+    std::remove((ingestFile + ".cols").c_str());
+    for (const char* reader : {"cache (write)", "cache (map)"}) {
+        auto start = std::chrono::high_resolution_clock::now();
+        TimeSeriesTable ingested = TimeSeriesTable::load(ingestFile, maxThreads);
+        double closeSum = 0;
+        for (size_t i = 0; i < ingested.size(); i++) closeSum += ingested.close()[i];
+        auto end = std::chrono::high_resolution_clock::now();
+        if (closeSum > 0) printIngest(reader, maxThreads, ingested.size(), std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::remove((ingestFile + ".cols").c_str());
+    std::remove(ingestFile.c_str());
+
+    std::cout << std::endl;
+
+    // ============ PART 9: Batched multi-window indicators ============
+    {
+        std::vector<int> batchWindows = {5, 10, 21, 50, 100, 200, 500, 1000};
+        std::vector<IndicatorSpec> batchSpecs;
+        for (int window : batchWindows) {
+            batchSpecs.push_back({IndicatorType::SMA, window});
+            batchSpecs.push_back({IndicatorType::WMA, window});
+        }
+        double outputs = double(batchSpecs.size()) * longPrices.size();
+
+        std::cout << "=== BATCHED INDICATORS (" << batchSpecs.size() << " series x " << longPrices.size()
+                  << " points) ===" << std::endl;
+        std::cout << std::setw(26) << "Method"
+                  << std::setw(15) << "Time (ms)"
+                  << std::setw(18) << "Outputs/s"
+                  << std::setw(16) << "Max rel diff" << std::endl;
+        std::cout << std::string(75, '-') << std::endl;
+
+        // Reference: one O(n) call per series, as PARTS 5 and 6
+        std::vector<std::vector<double>> reference(batchSpecs.size());
+        double separateMs = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t k = 0; k < batchSpecs.size(); k++) {
+                reference[k] = batchSpecs[k].type == IndicatorType::SMA
+                    ? calculateSMA_PrefixSum(longPrices, batchSpecs[k].window, maxThreads)
+                    : calculateWMA_Recurrence(longPrices, batchSpecs[k].window, maxThreads);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            separateMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        separateMs /= benchRuns;
+
+        // The output matrix is allocated once and refilled on every run
+        IndicatorMatrix batchOutputs(batchSpecs.size(), longPrices.size());
+        double batchedMs = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            calculateIndicators_Batched(longPrices, batchSpecs, maxThreads, batchOutputs);
+            auto end = std::chrono::high_resolution_clock::now();
+            batchedMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        batchedMs /= benchRuns;
+
+        double maxRelDiff = 0;
+        for (size_t k = 0; k < batchSpecs.size(); k++) {
+            for (size_t i = batchSpecs[k].window - 1; i < longPrices.size(); i++) {
+                maxRelDiff = std::max(maxRelDiff, std::abs(batchOutputs.row(k)[i] - reference[k][i]) / std::abs(reference[k][i]));
+            }
+        }
+
+        auto printBatch = [&](const char* method, double ms, bool withDiff) {
+            std::cout << std::setw(26) << method
+                      << std::setw(15) << std::fixed << std::setprecision(3) << ms
+                      << std::setw(18) << std::scientific << std::setprecision(3) << (outputs / (ms / 1000.0));
+            if (withDiff) std::cout << std::setw(16) << std::setprecision(2) << maxRelDiff;
+            std::cout << std::fixed << std::endl;
+        };
+        printBatch("Separate calls (O(n))", separateMs, false);
+        printBatch("Batched single pass", batchedMs, true);
+        std::cout << "Speedup: " << std::setprecision(2) << (separateMs / batchedMs) << "x" << std::endl;
+    }
+
+    std::cout << std::endl;
+
+    // ============ PART 10: Streaming replay ============
+    // Bar-by-bar updates against the batch results, on the CSV and on the long series
+    std::cout << "=== STREAMING REPLAY (O(1) updates per bar) ===" << std::endl;
+    for (const std::vector<double>* series : {&prices, &scanPrices}) {
+        const std::vector<double>& replay = *series;
+        StreamingIndicators stream(windowSizes);
+        IndicatorMatrix batch;
+        calculateIndicators_Batched(replay, accuracySpecs, maxThreads, batch);
+        std::vector<std::vector<double>> emaBatch;
+        for (int windowSize : windowSizes) emaBatch.push_back(calculateEMA_Scan(replay, windowSize, maxThreads));
+
+        LatencyRecorder latency;
+        double maxSMA = 0, maxWMA = 0, maxEMA = 0;
+        for (size_t i = 0; i < replay.size(); i++) {
+            auto start = std::chrono::steady_clock::now();
+            stream.update(replay[i]);
+            auto end = std::chrono::steady_clock::now();
+            latency.record(std::chrono::duration<double, std::nano>(end - start).count());
+            for (size_t k = 0; k < windowSizes.size(); k++) {
+                maxEMA = std::max(maxEMA, std::abs(stream.ema(k) - emaBatch[k][i]) / replay[i]);
+                if (!stream.ready(k)) continue;
+                maxSMA = std::max(maxSMA, std::abs(stream.sma(k) - batch.row(2 * k)[i]) / replay[i]);
+                maxWMA = std::max(maxWMA, std::abs(stream.wma(k) - batch.row(2 * k + 1)[i]) / replay[i]);
+            }
+        }
+        std::cout << (series == &prices ? csvFile : "synthetic") << " (" << replay.size() << " bars, "
+                  << windowSizes.size() << " windows), max rel diff vs batch: " << std::scientific << std::setprecision(2)
+                  << "SMA " << maxSMA << ", WMA " << maxWMA << ", EMA " << maxEMA << std::endl;
+        LatencyRecorder::printHeader(std::cout);
+        latency.print(std::cout, "indicator update");
+    }
+
+    std::cout << std::endl;
+
+    // ============ PART 11: Fused indicator + error evaluation ============
+    {
+        std::vector<IndicatorSpec> sweepSpecs;
+        for (int window = 5; window <= 200; window += 5) {
+            sweepSpecs.push_back({IndicatorType::SMA, window});
+            sweepSpecs.push_back({IndicatorType::WMA, window});
+        }
+        std::cout << "=== FUSED ERROR EVALUATION (" << sweepSpecs.size() << " series x " << longPrices.size()
+                  << " points) ===" << std::endl;
+        std::cout << std::setw(30) << "Method"
+                  << std::setw(15) << "Time (ms)"
+                  << std::setw(18) << "Series/s"
+                  << std::setw(16) << "Max MAPE diff" << std::endl;
+        std::cout << std::string(79, '-') << std::endl;
+
+        // Materialised: every series written to the matrix, then read back by calculateErrors
+        IndicatorMatrix sweepOutputs(sweepSpecs.size(), longPrices.size());
+        std::vector<ErrorMetrics> materialised(sweepSpecs.size());
+        double materialisedMs = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            calculateIndicators_Batched(longPrices, sweepSpecs, maxThreads, sweepOutputs);
+            for (size_t k = 0; k < sweepSpecs.size(); k++) {
+                materialised[k] = calculateErrors(longPrices, sweepOutputs.row(k), sweepSpecs[k].window);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            materialisedMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        materialisedMs /= benchRuns;
+
+        std::vector<ErrorMetrics> fused;
+        double fusedMs = 0;
+        for (int run = 0; run < benchRuns; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            fused = evaluateIndicators_Fused(longPrices, sweepSpecs, maxThreads);
+            auto end = std::chrono::high_resolution_clock::now();
+            fusedMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        fusedMs /= benchRuns;
+
+        double maxMapeDiff = 0;
+        for (size_t k = 0; k < sweepSpecs.size(); k++) {
+            maxMapeDiff = std::max(maxMapeDiff, std::abs(fused[k].mape - materialised[k].mape) / materialised[k].mape);
+        }
+        auto printSweep = [&](const char* method, double ms, bool withDiff) {
+            std::cout << std::setw(30) << method
+                      << std::setw(15) << std::fixed << std::setprecision(3) << ms
+                      << std::setw(18) << std::setprecision(1) << (sweepSpecs.size() / (ms / 1000.0));
+            if (withDiff) std::cout << std::setw(16) << std::scientific << std::setprecision(2) << maxMapeDiff;
+            std::cout << std::fixed << std::endl;
+        };
+        printSweep("Batched + calculateErrors", materialisedMs, false);
+        printSweep("Fused (no series written)", fusedMs, true);
+        std::cout << "Speedup: " << std::setprecision(2) << (materialisedMs / fusedMs) << "x" << std::endl;
+    }
+    std::cout << std::endl;
+
+    // ============ PART 12: Exhaustive window search ============
+    {
+        const int searchWindow = 1000;
+        auto start = std::chrono::high_resolution_clock::now();
+        WindowSearchResult search = searchBestWindows(prices, searchWindow, maxThreads);
+        auto end = std::chrono::high_resolution_clock::now();
+        double searchMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::cout << "=== EXHAUSTIVE WINDOW SEARCH (1.." << search.windows.size() << ", SMA and WMA) ===" << std::endl;
+        std::cout << std::setprecision(2) << "Searched " << 2 * search.windows.size() << " series in " << searchMs
+                  << " ms (" << std::scientific << (2.0 * search.windows.size() * prices.size() / (searchMs / 1000.0))
+                  << " forecasts/s)" << std::fixed << std::endl;
+        std::cout << std::setw(10) << "MA"
+                  << std::setw(14) << "Best by MAE"
+                  << std::setw(15) << "Best by RMSE"
+                  << std::setw(15) << "Best by MAPE"
+                  << std::setw(12) << "MAPE%" << std::endl;
+        std::cout << std::string(66, '-') << std::endl;
+        std::cout << std::setprecision(6)
+                  << std::setw(10) << "SMA"
+                  << std::setw(14) << search.bestSMA.mae
+                  << std::setw(15) << search.bestSMA.rmse
+                  << std::setw(15) << search.bestSMA.mape
+                  << std::setw(12) << search.sma[search.bestSMA.mape - 1].mape << std::endl;
+        std::cout << std::setw(10) << "WMA"
+                  << std::setw(14) << search.bestWMA.mae
+                  << std::setw(15) << search.bestWMA.rmse
+                  << std::setw(15) << search.bestWMA.mape
+                  << std::setw(12) << search.wma[search.bestWMA.mape - 1].mape << std::endl;
+
+        // The curve at roughly logarithmic steps
+        std::cout << std::endl;
+        std::cout << std::setw(10) << "Window"
+                  << std::setw(15) << "SMA MAPE%"
+                  << std::setw(15) << "WMA MAPE%" << std::endl;
+        std::cout << std::string(40, '-') << std::endl;
+        for (int window : {1, 2, 3, 5, 10, 20, 50, 100, 200, 500, 1000}) {
+            if (window > int(search.windows.size())) break;
+            std::cout << std::setw(10) << window
+                      << std::setw(15) << search.sma[window - 1].mape
+                      << std::setw(15) << search.wma[window - 1].mape << std::endl;
+        }
+    }
+
     std::cout << std::endl;
     std::cout << "=== CONCLUSIONS ===" << std::endl;
     std::cout << "1. Smaller window sizes provide better prediction accuracy (less lag)." << std::endl;